@@ -23,12 +23,17 @@ import grp
 import getpass
 import json
 import threading
+from concurrent.futures import ThreadPoolExecutor
 
 import openrazer_daemon.hardware
 from openrazer_daemon.dbus_services.service import DBusService
 from openrazer_daemon.device import DeviceCollection
 from openrazer_daemon.misc.screensaver_monitor import ScreensaverMonitor
 from openrazer_daemon.misc.autosave_persistence import PersistenceAutoSave
+from openrazer_daemon.misc.device_cache import DeviceCache
+
+# Upper bound of devices set up at the same time
+MAX_INIT_WORKERS = 8
 
 
 class RazerDaemon(DBusService):
@@ -87,12 +92,21 @@ class RazerDaemon(DBusService):
 
         self._persistence_file = persistence_file
         self._persistence = configparser.ConfigParser()
-        self._persistence.status = {"changed": False}
+        self._persistence_lock = threading.Lock()
+        # Devices hold this while reading their state from it
+        self._persistence.lock = self._persistence_lock
+        # Devices signal changed state through this, it starts writing once devices are loaded
+        self._persistence.autosave = PersistenceAutoSave(persistence_file, self.logger, 2, 10, self.write_persistence)
         self.read_persistence(persistence_file)
 
         # map of vid+pid to counter for serial numbers for unknown devices
         self._unknown_serial_counter: dict[tuple[int, int], int] = {}
 
+        # Static device info kept across restarts, next to the persistence file
+        self._device_cache = None
+        if persistence_file is not None:
+            self._device_cache = DeviceCache(os.path.join(os.path.dirname(persistence_file), 'device_cache.json'), __version__)
+
         # Check for plugdev group
         if not self._check_plugdev_group():
             self.logger.critical("User is not a member of the plugdev group")
@@ -112,11 +126,18 @@ class RazerDaemon(DBusService):
 
         # Load Classes
         self._device_classes = openrazer_daemon.hardware.get_device_classes()
+        self._supported_ids = {'{0:04X}:{1:04X}'.format(cls.USB_VID, cls.USB_PID) for cls in self._device_classes}
 
         self.logger.info("Initialising Daemon (v%s). Pid: %d", __version__, os.getpid())
         self._init_screensaver_monitor()
 
         self._razer_devices = DeviceCollection()
+        # Index of the HID interfaces of a USB device, keyed by its USB parent
+        self._hotplug_lock = threading.Lock()
+        self._usb_parents = {}  # USB parent -> sys_name of the device owning it
+        self._interface_parents = {}  # sys_name of any indexed interface -> USB parent
+        self._orphan_interfaces = {}  # USB parent -> sys_paths seen before their device
+        self._adding_devices = set()  # sys_names of hotplugged devices still being set up
         self._load_devices(first_run=True)
 
         # Add DBus methods
@@ -216,14 +237,11 @@ class RazerDaemon(DBusService):
             self.logger.error("Failed to init ScreensaverMonitor: {}".format(e))
 
     def _init_autosave_persistence(self):
-        if not self._persistence:
-            self.logger.debug("Persistence unspecified. Will not create auto save thread")
+        if not self._persistence_file:
+            self.logger.debug("Persistence unspecified. Will not start auto save thread")
             return
 
-        self._autosave_persistence = PersistenceAutoSave(self._persistence, self._persistence_file, self._persistence.status, self.logger, 10, self.write_persistence)
-        self._autosave_persistence.thread = threading.Thread(target=self._autosave_persistence.watch)
-        self._autosave_persistence.thread.daemon = True
-        self._autosave_persistence.thread.start()
+        self._persistence.autosave.start()
 
     def _init_signals(self):
         """
@@ -313,19 +331,37 @@ class RazerDaemon(DBusService):
                 with open(persistence_file, "w") as f:
                     f.writelines("")
 
-    def write_persistence(self, persistence_file):
+    def write_persistence(self, persistence_file, sections=None, devices=None):
         """
         Write in the persistence file
 
+        The file is replaced atomically, so a crash while writing doesn't lose it.
+
         :param persistence_file: Persistence file
         :type persistence_file: str or None
+
+        :param sections: Storage names of the devices whose state changed, all devices if None
+        :type sections: set or None
+
+        :param devices: Devices to write, the devices in the collection if None
+        :type devices: list or None
         """
         if not persistence_file:
             return
 
+        if devices is None:
+            devices = list(self._razer_devices)
+
+        with self._persistence_lock:
+            self._write_persistence(persistence_file, sections, devices)
+
+    def _write_persistence(self, persistence_file, sections, devices):
         self.logger.debug('Writing persistence config')
 
-        for device in self._razer_devices:
+        for device in devices:
+            if sections is not None and device.dbus.storage_name not in sections:
+                continue
+
             self._persistence[device.dbus.storage_name] = {}
             if 'set_dpi_xy' in device.dbus.METHODS or 'set_dpi_xy_byte' in device.dbus.METHODS:
                 dpi_x = int(device.dbus.dpi[0])
@@ -347,8 +383,19 @@ class RazerDaemon(DBusService):
                     self._persistence[device.dbus.storage_name][i + '_speed'] = str(device.dbus.zone[i]["speed"])
                     self._persistence[device.dbus.storage_name][i + '_wave_dir'] = str(device.dbus.zone[i]["wave_dir"])
 
-        with open(persistence_file, 'w') as cf:
+        tmp_file = persistence_file + '.tmp'
+        with open(tmp_file, 'w') as cf:
             self._persistence.write(cf)
+            cf.flush()
+            os.fsync(cf.fileno())
+        os.replace(tmp_file, persistence_file)
+
+        # Make the rename itself survive a crash
+        dir_fd = os.open(os.path.dirname(os.path.abspath(persistence_file)), os.O_RDONLY | os.O_DIRECTORY)
+        try:
+            os.fsync(dir_fd)
+        finally:
+            os.close(dir_fd)
 
     def get_off_on_screensaver(self):
         """
@@ -448,6 +495,17 @@ class RazerDaemon(DBusService):
             device_list = list(self._udev_context.list_devices(subsystem='hid'))
             test_mode = False
 
+        start_time = time.monotonic()
+        pending = []
+        queued = set()
+        usb_parents = {}
+
+        # Group the interfaces of each USB device once instead of scanning the list per device
+        siblings = {}
+        if not test_mode:
+            for device in device_list:
+                siblings.setdefault(self._usb_parent(device.sys_name, device), []).append(device)
+
         device_number = 0
         for device in device_list:
 
@@ -460,7 +518,7 @@ class RazerDaemon(DBusService):
                     sys_name = device.sys_name
                     sys_path = device.sys_path
 
-                if sys_name in self._razer_devices:
+                if sys_name in self._razer_devices or sys_name in queued:
                     continue
 
                 if device_class.match(sys_name, sys_path):  # Check it matches sys/ ID format and has device_type file
@@ -468,19 +526,16 @@ class RazerDaemon(DBusService):
 
                     # TODO add testdir support
                     # Basically find the other usb interfaces
-                    device_match = sys_name.split('.')[0]
+                    usb_parent = self._usb_parent(sys_name, None if test_mode else device)
                     additional_interfaces = []
                     if not test_mode:
-                        double_device = False
-                        for alt_device in self._razer_devices:
-                            if device_match in alt_device.device_id and alt_device.device_id != sys_name and sys_path in alt_device.dbus.additional_interfaces:
-                                self.logger.warning('BUG: Device %s has already been found with interface %s. Skipping', sys_name, alt_device.device_id)
-                                double_device = True
-                        if double_device:
+                        owner = self._usb_parents.get(usb_parent)
+                        if owner is not None and owner != sys_name and sys_path in self._razer_devices[owner].dbus.additional_interfaces:
+                            self.logger.warning('BUG: Device %s has already been found with interface %s. Skipping', sys_name, owner)
                             continue
 
-                        for alt_device in device_list:
-                            if device_match in alt_device.sys_name and alt_device.sys_name != sys_name:
+                        for alt_device in siblings.get(usb_parent, []):
+                            if alt_device.sys_name != sys_name:
                                 additional_interfaces.append(alt_device.sys_path)
 
                     # Checking permissions
@@ -492,71 +547,252 @@ class RazerDaemon(DBusService):
                         self.logger.critical("Could not access {0}/device_type, file is not owned by plugdev".format(sys_path))
                         break
 
-                    razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
-                                                persistence=self._persistence, testing=self._test_dir is not None,
-                                                additional_interfaces=sorted(additional_interfaces),
-                                                additional_methods=[],
-                                                unknown_serial_counter=self._unknown_serial_counter)
-
-                    # Wireless devices sometimes don't listen
-                    count = 0
-                    while count < 3:
-                        # Loop to get serial, exit early if it gets one
-                        device_serial = razer_device.get_serial()
-                        if len(device_serial) > 0:
-                            break
-                        time.sleep(0.1)
-                        count += 1
-                    else:
-                        logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
-                        continue
-
-                    self._razer_devices.add(sys_name, device_serial, razer_device)
+                    pending.append((device_class, sys_name, sys_path, device_number, sorted(additional_interfaces)))
+                    queued.add(sys_name)
+                    usb_parents[sys_name] = usb_parent
 
                     device_number += 1
 
+        if not pending:
+            return
+
+        # Setting up a device is mostly waiting on USB transfers (serial, firmware,
+        # restoring effects), so set up different models at the same time. Devices
+        # of the same model stay in order so generated serials don't change
+        # between runs. Devices are still added in the order they were found.
+        groups = {}
+        for job in pending:
+            groups.setdefault(job[0], []).append(job)
+
+        with ThreadPoolExecutor(max_workers=min(len(groups), MAX_INIT_WORKERS), thread_name_prefix='razer-init') as executor:
+            futures = [executor.submit(self._init_devices, jobs) for jobs in groups.values()]
+
+            results = {}
+            error = None
+            for future in futures:
+                try:
+                    results.update(future.result())
+                except Exception as err:
+                    error = error or err
+
+        if error is not None:
+            # Don't leave the devices of the other models on DBus
+            self._close_devices(results.values())
+            raise error
+
+        added = 0
+        for job in pending:
+            result = results[job[3]]
+            if result is not None:
+                self._razer_devices.add(*result)
+                self._index_device(result[0], usb_parents[result[0]], result[2].additional_interfaces)
+                added += 1
+
+        self.logger.info('Initialised %d device(s) in %.0f ms', added, (time.monotonic() - start_time) * 1000)
+
+        if self._device_cache is not None:
+            self._device_cache.save()
+
+    def _init_devices(self, jobs):
+        """
+        Create the devices of one model one after another
+
+        Runs on a worker thread of _load_devices. If one fails the devices
+        created before it are closed again.
+
+        :param jobs: Arguments for _init_device
+        :type jobs: list
+
+        :return: Device number and _init_device result of every job
+        :rtype: list
+        """
+        results = []
+        try:
+            for job in jobs:
+                results.append((job[3], self._init_device(*job)))
+        except Exception:
+            self._close_devices(result for _, result in results)
+            raise
+
+        return results
+
+    @staticmethod
+    def _close_devices(results):
+        """
+        Close devices created by _init_device that weren't added
+
+        :param results: _init_device results
+        :type results: iterable
+        """
+        for result in results:
+            if result is not None:
+                result[2].close()
+                result[2].remove_from_connection()
+
+    def _init_device(self, device_class, sys_name, sys_path, device_number, additional_interfaces):
+        """
+        Create a device and get its serial
+
+        Runs on a worker thread of _load_devices
+
+        :return: Tuple of sys_name, serial and device or None if the device didn't give a serial
+        :rtype: tuple or None
+        """
+        start_time = time.monotonic()
+
+        razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
+                                    persistence=self._persistence, testing=self._test_dir is not None,
+                                    additional_interfaces=additional_interfaces,
+                                    additional_methods=[],
+                                    unknown_serial_counter=self._unknown_serial_counter,
+                                    device_cache=self._device_cache)
+
+        # Wireless devices sometimes don't listen
+        count = 0
+        while count < 3:
+            # Loop to get serial, exit early if it gets one
+            device_serial = razer_device.get_serial()
+            if len(device_serial) > 0:
+                break
+            time.sleep(0.1)
+            count += 1
+        else:
+            logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
+            return None
+
+        self.logger.info('Initialised device.%d %s in %.0f ms', device_number, sys_name, (time.monotonic() - start_time) * 1000)
+
+        return sys_name, device_serial, razer_device
+
+    @staticmethod
+    def _usb_parent(sys_name, udev_device=None):
+        """
+        Get the key the HID interfaces of one USB device have in common
+
+        :param sys_name: Name of the HID interface, e.g. 0003:1532:0203.0001
+        :type sys_name: str
+
+        :param udev_device: Udev device of the interface, if there is one
+        :type udev_device: pyudev.device._device.Device or None
+
+        :return: Path of the USB device or the bus:vid:pid part of the name if it has none
+        :rtype: str
+        """
+        if udev_device is not None:
+            usb_device = udev_device.find_parent('usb', 'usb_device')
+            if usb_device is not None:
+                return usb_device.sys_path
+
+        return sys_name.split('.')[0]
+
+    @staticmethod
+    def _usb_ids(sys_name):
+        """
+        Get the vendor and product ID of a HID interface
+
+        :param sys_name: Name of the HID interface, bus:vid:pid.instance e.g. 0003:1532:0203.0001
+        :type sys_name: str
+
+        :return: vid:pid part of the name e.g. 1532:0203, None if it isn't a HID interface
+        :rtype: str or None
+        """
+        fields = sys_name.split(':')
+        if len(fields) != 3:
+            return None
+
+        vid = fields[1]
+        pid = fields[2].split('.')[0]
+        return '{0}:{1}'.format(vid, pid)
+
+    def _index_device(self, sys_name, usb_parent, additional_interfaces):
+        """
+        Add a device and its other interfaces to the USB parent index
+        """
+        self._usb_parents[usb_parent] = sys_name
+        self._interface_parents[sys_name] = usb_parent
+        for interface_path in additional_interfaces:
+            self._interface_parents[os.path.basename(interface_path)] = usb_parent
+
     def _add_device(self, device):
         """
         Add device event from udev
 
+        Only looks at the interface in the event, other interfaces of the
+        same USB device are found through the USB parent index.
+
         :param device: Udev Device
         :type device: pyudev.device._device.Device
         """
-        device_number = len(self._razer_devices)
-        for device_class in self._device_classes:
-            sys_name = device.sys_name
-            sys_path = device.sys_path
+        sys_name = device.sys_name
+        sys_path = device.sys_path
 
-            if sys_name in self._razer_devices:
-                continue
+        # Not a Razer device we know about, e.g. any other keyboard or mouse
+        if self._usb_ids(sys_name) not in self._supported_ids:
+            return
 
-            if device_class.match(sys_name, sys_path):  # Check it matches sys/ ID format and has device_type file
-                self.logger.info('Found valid device.%d: %s', device_number, sys_name)
-                razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
-                                            persistence=self._persistence, testing=self._test_dir is not None,
-                                            additional_interfaces=None, additional_methods=[],
-                                            unknown_serial_counter=self._unknown_serial_counter)
+        # The lock only guards the index, creating the device takes a while
+        with self._hotplug_lock:
+            if sys_name in self._razer_devices or sys_name in self._adding_devices:
+                return
+
+            usb_parent = self._usb_parent(sys_name, device)
+            device_class = next((cls for cls in self._device_classes if cls.match(sys_name, sys_path)), None)
+
+            if device_class is None:
+                # Another interface of a USB device, attach it to its device or keep
+                # it around until the device shows up
+                owner = self._usb_parents.get(usb_parent)
+                if owner is not None:
+                    additional_interfaces = self._razer_devices[owner].dbus.additional_interfaces
+                    if sys_path not in additional_interfaces:
+                        additional_interfaces.append(sys_path)
+                else:
+                    self._orphan_interfaces.setdefault(usb_parent, []).append(sys_path)
+                self._interface_parents[sys_name] = usb_parent
+                return
 
-                # Its a udev event so currently the device hasn't been chmodded yet
-                time.sleep(0.2)
+            device_number = len(self._razer_devices) + len(self._adding_devices)
+            self._adding_devices.add(sys_name)
+            additional_interfaces = self._orphan_interfaces.pop(usb_parent, None)
 
-                # Wireless devices sometimes don't listen
-                device_serial = razer_device.get_serial()
+        self.logger.info('Found valid device.%d: %s', device_number, sys_name)
+        razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
+                                    persistence=self._persistence, testing=self._test_dir is not None,
+                                    additional_interfaces=additional_interfaces, additional_methods=[],
+                                    unknown_serial_counter=self._unknown_serial_counter,
+                                    device_cache=self._device_cache)
 
-                if len(device_serial) > 0:
-                    # Add Device
-                    self._razer_devices.add(sys_name, device_serial, razer_device)
-                    self.device_added()
-                else:
-                    logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
-            else:
-                # Basically find the other usb interfaces
-                device_match = sys_name.split('.')[0]
-                for d in self._razer_devices:
-                    if device_match in d.device_id and d.device_id != sys_name:
-                        if not sys_path in d.dbus.additional_interfaces:
-                            d.dbus.additional_interfaces.append(sys_path)
-                            return
+        # Its a udev event so currently the device hasn't been chmodded yet
+        time.sleep(0.2)
+
+        # Wireless devices sometimes don't listen
+        device_serial = razer_device.get_serial()
+
+        with self._hotplug_lock:
+            if sys_name not in self._adding_devices:
+                # Unplugged again while it was set up
+                razer_device.close()
+                razer_device.remove_from_connection()
+                return
+            self._adding_devices.discard(sys_name)
+
+            if len(device_serial) == 0:
+                logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
+                return
+
+            # Other interfaces that showed up in the meantime
+            for interface_path in self._orphan_interfaces.pop(usb_parent, []):
+                if interface_path not in razer_device.additional_interfaces:
+                    razer_device.additional_interfaces.append(interface_path)
+
+            # Add Device
+            self._razer_devices.add(sys_name, device_serial, razer_device)
+            self._index_device(sys_name, usb_parent, razer_device.additional_interfaces)
+
+        self.device_added()
+
+        if self._device_cache is not None:
+            self._device_cache.save()
 
     def _remove_device(self, device):
         """
@@ -567,21 +803,37 @@ class RazerDaemon(DBusService):
         """
         device_id = device.sys_name
 
-        try:
-            device = self._razer_devices[device_id]
+        with self._hotplug_lock:
+            usb_parent = self._interface_parents.pop(device_id, None)
 
-            device.dbus.close()
-            device.dbus.remove_from_connection()
-            self.write_persistence(self._persistence_file)
-            self.logger.warning("Removing %s", device_id)
+            if device_id in self._adding_devices:
+                # _add_device drops it once it's set up
+                self._adding_devices.discard(device_id)
+                return
 
-            # Delete device
-            del self._razer_devices[device.device_id]
-            self.device_removed()
+            if device_id not in self._razer_devices:
+                # It will return "extra" events for the additional usb interfaces bound to the driver
+                owner = self._usb_parents.get(usb_parent)
+                if owner is not None:
+                    additional_interfaces = self._razer_devices[owner].dbus.additional_interfaces
+                    if device.sys_path in additional_interfaces:
+                        additional_interfaces.remove(device.sys_path)
+                elif usb_parent in self._orphan_interfaces:
+                    self._orphan_interfaces[usb_parent] = [path for path in self._orphan_interfaces[usb_parent] if os.path.basename(path) != device_id]
+                return
 
-        except IndexError:  # Why didn't i set it up as KeyError
-            # It will return "extra" events for the additional usb interfaces bound to the driver
-            pass
+            # Take it out of the index, closing it can block on the device
+            device = self._razer_devices[device_id]
+            del self._razer_devices[device_id]
+            if self._usb_parents.get(usb_parent) == device_id:
+                del self._usb_parents[usb_parent]
+
+        self.logger.warning("Removing %s", device_id)
+
+        device.dbus.close()
+        device.dbus.remove_from_connection()
+        self.write_persistence(self._persistence_file, devices=[device])
+        self.device_removed()
 
     def _udev_input_event(self, device):
         """
@@ -592,24 +844,26 @@ class RazerDaemon(DBusService):
         """
         self.logger.debug('Device event [%s]: %s', device.action, device.device_path)
         if device.action == 'add':
-            if self._collecting_udev:
-                self._collecting_udev_devices.append(device)
-                return
-            else:
-                self._collecting_udev_devices = [device]
-                self._collecting_udev = True
-                t = threading.Thread(target=self._collecting_udev_method, args=(device,))
-                t.start()
+            with self._hotplug_lock:
+                if self._collecting_udev:
+                    self._collecting_udev_devices.append(device)
+                    return
+                else:
+                    self._collecting_udev_devices = [device]
+                    self._collecting_udev = True
+            t = threading.Thread(target=self._collecting_udev_method, args=(device,))
+            t.start()
         elif device.action == 'remove':
             self._remove_device(device)
 
     def _collecting_udev_method(self, device):
         time.sleep(2)  # delay to let udev add all devices that we want
         # Sort the devices
-        self._collecting_udev_devices.sort(key=lambda x: x.sys_path, reverse=True)
-        for d in self._collecting_udev_devices:
+        with self._hotplug_lock:
+            devices = sorted(self._collecting_udev_devices, key=lambda x: x.sys_path, reverse=True)
+            self._collecting_udev = False
+        for d in devices:
             self._add_device(d)
-        self._collecting_udev = False
 
     def run(self):
         """
@@ -655,4 +909,8 @@ class RazerDaemon(DBusService):
             device.dbus.close()
 
         # Write config
+        self._persistence.autosave.close()
         self.write_persistence(self._persistence_file)
+
+        if self._device_cache is not None:
+            self._device_cache.save()
@@ -63,10 +63,13 @@ def get_firmware(self):
     """
     self.logger.debug("DBus call get_firmware")
 
-    driver_path = self.get_driver_path('firmware_version')
+    def read_firmware():
+        driver_path = self.get_driver_path('firmware_version')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip()
+        with open(driver_path, 'r') as driver_file:
+            return driver_file.read().strip()
+
+    return self.get_static_info('firmware', read_firmware)
 
 
 @endpoint('razer.device.misc', 'getDeviceName', out_sig='s')
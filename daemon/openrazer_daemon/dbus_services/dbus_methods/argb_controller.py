@@ -44,8 +44,7 @@ def _set_channel_brightness(self, channel, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -101,8 +100,7 @@ def _set_channel_size(self, channel, size):
 
     self.set_persistence(channel, "size", int(size))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(size))
+    self.write_driver_file(driver_path, str(size))
 
     # Notify others
     self.send_effect_event('setSize', size)
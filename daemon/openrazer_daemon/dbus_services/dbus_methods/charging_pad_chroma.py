@@ -37,8 +37,7 @@ def set_charging_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -65,8 +64,7 @@ def set_charging_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingStatic', in_sig='yyy')
@@ -96,8 +94,7 @@ def set_charging_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingSpectrum')
@@ -115,8 +112,7 @@ def set_charging_spectrum(self):
 
     effect_driver_path = self.get_driver_path('charging_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingNone')
@@ -134,8 +130,7 @@ def set_charging_none(self):
 
     driver_path = self.get_driver_path('charging_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingBreathRandom')
@@ -155,8 +150,7 @@ def set_charging_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingBreathSingle', in_sig='yyy')
@@ -186,8 +180,7 @@ def set_charging_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingBreathDual', in_sig='yyyyyy')
@@ -226,8 +219,7 @@ def set_charging_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fast_charging', 'getFastChargingBrightness', out_sig='d')
@@ -264,8 +256,7 @@ def set_fast_charging_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -292,8 +283,7 @@ def set_fast_charging_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingStatic', in_sig='yyy')
@@ -323,8 +313,7 @@ def set_fast_charging_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingSpectrum')
@@ -342,8 +331,7 @@ def set_fast_charging_spectrum(self):
 
     effect_driver_path = self.get_driver_path('fast_charging_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingNone')
@@ -361,8 +349,7 @@ def set_fast_charging_none(self):
 
     driver_path = self.get_driver_path('fast_charging_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingBreathRandom')
@@ -382,8 +369,7 @@ def set_fast_charging_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingBreathSingle', in_sig='yyy')
@@ -413,8 +399,7 @@ def set_fast_charging_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingBreathDual', in_sig='yyyyyy')
@@ -453,8 +438,7 @@ def set_fast_charging_breath_dual(self, red1, green1, blue1, red2, green2, blue2
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fully_charged', 'getFullyChargedBrightness', out_sig='d')
@@ -491,8 +475,7 @@ def set_fully_charged_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -519,8 +502,7 @@ def set_fully_charged_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedStatic', in_sig='yyy')
@@ -550,8 +532,7 @@ def set_fully_charged_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedSpectrum')
@@ -569,8 +550,7 @@ def set_fully_charged_spectrum(self):
 
     effect_driver_path = self.get_driver_path('fully_charged_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedNone')
@@ -588,8 +568,7 @@ def set_fully_charged_none(self):
 
     driver_path = self.get_driver_path('fully_charged_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedBreathRandom')
@@ -609,8 +588,7 @@ def set_fully_charged_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedBreathSingle', in_sig='yyy')
@@ -640,8 +618,7 @@ def set_fully_charged_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedBreathDual', in_sig='yyyyyy')
@@ -680,5 +657,4 @@ def set_fully_charged_breath_dual(self, red1, green1, blue1, red2, green2, blue2
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
@@ -4,6 +4,7 @@
 BlackWidow Chroma Effects
 """
 import os
+import dbus
 from openrazer_daemon.dbus_services import endpoint
 
 
@@ -43,8 +44,7 @@ def set_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -85,15 +85,12 @@ def set_game_mode(self, enable):
     alt_tab = self.get_driver_path('key_alt_tab')
     alt_f4 = self.get_driver_path('key_alt_f4')
 
+    key_state = b'\x01' if enable else b'\x00'
+
     if os.path.exists(super_file):
-        if enable:
-            open(super_file, 'wb').write(b'\x01')
-            open(alt_tab, 'wb').write(b'\x01')
-            open(alt_f4, 'wb').write(b'\x01')
-        else:
-            open(super_file, 'wb').write(b'\x00')
-            open(alt_tab, 'wb').write(b'\x00')
-            open(alt_f4, 'wb').write(b'\x00')
+        self.write_driver_file(super_file, key_state)
+        self.write_driver_file(alt_tab, key_state)
+        self.write_driver_file(alt_f4, key_state)
     else:
         for kb_int in self.additional_interfaces:
             super_file = os.path.join(kb_int, 'key_super')
@@ -104,20 +101,11 @@ def set_game_mode(self, enable):
             # without key_super, key_alt_tab and key_alt_f4 files. We have to go
             # through all interfaces and check if these files are actually available
             if os.path.exists(super_file):
-                if enable:
-                    open(super_file, 'wb').write(b'\x01')
-                    open(alt_tab, 'wb').write(b'\x01')
-                    open(alt_f4, 'wb').write(b'\x01')
-                else:
-                    open(super_file, 'wb').write(b'\x00')
-                    open(alt_tab, 'wb').write(b'\x00')
-                    open(alt_f4, 'wb').write(b'\x00')
-
-    with open(driver_path, 'w') as driver_file:
-        if enable:
-            driver_file.write('1')
-        else:
-            driver_file.write('0')
+                self.write_driver_file(super_file, key_state)
+                self.write_driver_file(alt_tab, key_state)
+                self.write_driver_file(alt_f4, key_state)
+
+    self.write_driver_file(driver_path, '1' if enable else '0')
 
 
 @endpoint('razer.device.led.macromode', 'getMacroMode', out_sig='b')
@@ -148,11 +136,7 @@ def set_macro_mode(self, enable):
 
     driver_path = self.get_driver_path('macro_led_state')
 
-    with open(driver_path, 'w') as driver_file:
-        if enable:
-            driver_file.write('1')
-        else:
-            driver_file.write('0')
+    self.write_driver_file(driver_path, '1' if enable else '0')
 
 
 @endpoint('razer.device.misc.keyswitchoptimization', 'getKeyswitchOptimization', out_sig='b')
@@ -183,11 +167,7 @@ def set_keyswitch_optimization(self, enable):
 
     driver_path = self.get_driver_path('keyswitch_optimization')
 
-    with open(driver_path, 'w') as driver_file:
-        if enable:
-            driver_file.write('1')
-        else:
-            driver_file.write('0')
+    self.write_driver_file(driver_path, '1' if enable else '0')
 
 
 @endpoint('razer.device.led.macromode', 'getMacroEffect', out_sig='i')
@@ -218,8 +198,7 @@ def set_macro_effect(self, effect):
 
     driver_path = self.get_driver_path('macro_led_effect')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(effect)))
+    self.write_driver_file(driver_path, str(int(effect)))
 
 
 @endpoint('razer.device.lighting.chroma', 'setWave', in_sig='i')
@@ -244,8 +223,7 @@ def set_wave_effect(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.chroma', 'setWheel', in_sig='i')
@@ -272,8 +250,7 @@ def set_wheel_effect(self, direction):
     if direction not in (1, 2):
         direction = 1
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.chroma', 'setStatic', in_sig='yyy')
@@ -303,8 +280,7 @@ def set_static_effect(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBlinking', in_sig='yyy')
@@ -334,8 +310,7 @@ def set_blinking_effect(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setSpectrum')
@@ -353,8 +328,7 @@ def set_spectrum_effect(self):
 
     driver_path = self.get_driver_path('matrix_effect_spectrum')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.chroma', 'setNone')
@@ -372,8 +346,7 @@ def set_none_effect(self):
 
     driver_path = self.get_driver_path('matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.misc', 'triggerReactive')
@@ -388,8 +361,7 @@ def trigger_reactive_effect(self):
 
     driver_path = self.get_driver_path('matrix_reactive_trigger')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.chroma', 'setReactive', in_sig='yyyy')
@@ -427,8 +399,7 @@ def set_reactive_effect(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathRandom')
@@ -448,8 +419,7 @@ def set_breath_random_effect(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathSingle', in_sig='yyy')
@@ -479,8 +449,7 @@ def set_breath_single_effect(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathDual', in_sig='yyyyyy')
@@ -519,8 +488,7 @@ def set_breath_dual_effect(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathTriple', in_sig='yyyyyyyyy')
@@ -568,8 +536,7 @@ def set_breath_triple_effect(self, red1, green1, blue1, red2, green2, blue2, red
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2, red3, green3, blue3])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setCustom')
@@ -579,7 +546,7 @@ def set_custom_effect(self):
     """
     self.send_effect_event('setCustom')
 
-    self._set_custom_effect()
+    self.queue_write(('set_custom_effect',), self._set_custom_effect)
 
 
 @endpoint('razer.device.lighting.chroma', 'setKeyRow', in_sig='ay', byte_arrays=True)
@@ -598,7 +565,55 @@ def set_key_row(self, payload):
     """
     self.send_effect_event('setCustom')
 
-    self._set_key_row(payload)
+    self.queue_write(self._key_row_key(payload), self._set_key_row, bytes(payload))
+
+
+@endpoint('razer.device.lighting.chroma', 'openFrameStream', out_sig='h')
+def open_frame_stream(self):
+    """
+    Open a socket to stream custom frames over
+
+    Every message sent on the socket is applied like setKeyRow followed by
+    setCustom, without a DBus call per frame. Opening a new stream closes
+    the previous one.
+
+    :return: Client end of a SOCK_SEQPACKET socket
+    :rtype: dbus.types.UnixFd
+    """
+    self.logger.debug("DBus call open_frame_stream")
+
+    self.send_effect_event('setCustom')
+
+    client_fd = self._open_frame_stream()
+    try:
+        # UnixFd duplicates the descriptor
+        return dbus.types.UnixFd(client_fd)
+    finally:
+        os.close(client_fd)
+
+
+@endpoint('razer.device.lighting.chroma', 'openFrameRing', out_sig='hh')
+def open_frame_ring(self):
+    """
+    Open a shared memory ring to draw custom frames into
+
+    The memory starts with a header of four little endian uint32: sequence
+    number of the newest frame, number of slots, frame size and a closed
+    flag. Frame N is stored in slot N % slots as a setKeyRow payload covering
+    every row of the matrix. After publishing a frame by bumping the sequence
+    number the client writes to the eventfd, the daemon then applies the
+    newest frame and skips older ones.
+
+    :return: Shared memory and eventfd
+    :rtype: tuple
+    """
+    self.logger.debug("DBus call open_frame_ring")
+
+    self.send_effect_event('setCustom')
+
+    memfd, eventfd = self._open_frame_ring()
+
+    return dbus.types.UnixFd(memfd), dbus.types.UnixFd(eventfd)
 
 
 @endpoint('razer.device.lighting.custom', 'setRipple', in_sig='yyyd')
@@ -652,14 +667,13 @@ def set_starlight_random_effect(self, speed):
     """
     self.logger.debug("DBus call set_starlight_random")
 
-    driver_path = self.get_driver_path('matrix_effect_starlight')
-
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([speed]))
-
     # Notify others
     self.send_effect_event('setStarlightRandom')
 
+    driver_path = self.get_driver_path('matrix_effect_starlight')
+
+    self.write_driver_file(driver_path, bytes([speed]))
+
     # remember effect
     self.set_persistence("backlight", "effect", 'starlightRandom')
     self.set_persistence("backlight", "speed", int(speed))
@@ -672,14 +686,13 @@ def set_starlight_single_effect(self, red, green, blue, speed):
     """
     self.logger.debug("DBus call set_starlight_single")
 
-    driver_path = self.get_driver_path('matrix_effect_starlight')
-
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([speed, red, green, blue]))
-
     # Notify others
     self.send_effect_event('setStarlightSingle', red, green, blue, speed)
 
+    driver_path = self.get_driver_path('matrix_effect_starlight')
+
+    self.write_driver_file(driver_path, bytes([speed, red, green, blue]))
+
     # remember effect
     self.set_persistence("backlight", "effect", 'starlightSingle')
     self.set_persistence("backlight", "speed", int(speed))
@@ -693,14 +706,13 @@ def set_starlight_dual_effect(self, red1, green1, blue1, red2, green2, blue2, sp
     """
     self.logger.debug("DBus call set_starlight_dual")
 
-    driver_path = self.get_driver_path('matrix_effect_starlight')
-
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([speed, red1, green1, blue1, red2, green2, blue2]))
-
     # Notify others
     self.send_effect_event('setStarlightDual', red1, green1, blue1, red2, green2, blue2, speed)
 
+    driver_path = self.get_driver_path('matrix_effect_starlight')
+
+    self.write_driver_file(driver_path, bytes([speed, red1, green1, blue1, red2, green2, blue2]))
+
     # remember effect
     self.set_persistence("backlight", "effect", 'starlightDual')
     self.set_persistence("backlight", "speed", int(speed))
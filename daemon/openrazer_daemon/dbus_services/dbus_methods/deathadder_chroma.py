@@ -33,8 +33,7 @@ def set_backlight_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -62,8 +61,7 @@ def set_logo_active(self, active):
 
     driver_path = self.get_driver_path('logo_led_state')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1' if active else '0')
+    self.write_driver_file(driver_path, '1' if active else '0')
 
 
 @endpoint('razer.device.lighting.logo', 'getLogoBrightness', out_sig='d')
@@ -96,8 +94,7 @@ def set_logo_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -133,8 +130,7 @@ def set_scroll_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -34,11 +34,7 @@ def keypad_set_profile_led_red(self, enable):
 
     driver_path = self.get_driver_path('profile_led_red')
 
-    with open(driver_path, 'w') as driver_file:
-        if enable:
-            driver_file.write('1')
-        else:
-            driver_file.write('0')
+    self.write_driver_file(driver_path, '1' if enable else '0')
 
 
 @endpoint('razer.device.lighting.profile_led', 'getGreenLED', out_sig='b')
@@ -69,11 +65,7 @@ def keypad_set_profile_led_green(self, enable):
 
     driver_path = self.get_driver_path('profile_led_green')
 
-    with open(driver_path, 'w') as driver_file:
-        if enable:
-            driver_file.write('1')
-        else:
-            driver_file.write('0')
+    self.write_driver_file(driver_path, '1' if enable else '0')
 
 
 @endpoint('razer.device.lighting.profile_led', 'getBlueLED', out_sig='b')
@@ -104,11 +96,7 @@ def keypad_set_profile_led_blue(self, enable):
 
     driver_path = self.get_driver_path('profile_led_blue')
 
-    with open(driver_path, 'w') as driver_file:
-        if enable:
-            driver_file.write('1')
-        else:
-            driver_file.write('0')
+    self.write_driver_file(driver_path, '1' if enable else '0')
 
 
 @endpoint('razer.device.macro', 'getModeModifier', out_sig='b')
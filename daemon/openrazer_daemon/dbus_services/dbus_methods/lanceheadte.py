@@ -25,8 +25,7 @@ def set_logo_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollWave', in_sig='i')
@@ -51,8 +50,7 @@ def set_scroll_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.left', 'getLeftBrightness', out_sig='d')
@@ -91,8 +89,7 @@ def set_left_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -120,8 +117,7 @@ def set_left_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.left', 'setLeftStatic', in_sig='yyy')
@@ -151,8 +147,7 @@ def set_left_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftSpectrum')
@@ -170,8 +165,7 @@ def set_left_spectrum(self):
 
     effect_driver_path = self.get_driver_path('left_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.left', 'setLeftNone')
@@ -189,8 +183,7 @@ def set_left_none(self):
 
     driver_path = self.get_driver_path('left_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.left', 'setLeftReactive', in_sig='yyyy')
@@ -228,8 +221,7 @@ def set_left_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftBreathRandom')
@@ -249,8 +241,7 @@ def set_left_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftBreathSingle', in_sig='yyy')
@@ -280,8 +271,7 @@ def set_left_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftBreathDual', in_sig='yyyyyy')
@@ -320,8 +310,7 @@ def set_left_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'getRightBrightness', out_sig='d')
@@ -359,8 +348,7 @@ def set_right_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -388,8 +376,7 @@ def set_right_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.right', 'setRightStatic', in_sig='yyy')
@@ -419,8 +406,7 @@ def set_right_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightSpectrum')
@@ -438,8 +424,7 @@ def set_right_spectrum(self):
 
     effect_driver_path = self.get_driver_path('right_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.right', 'setRightNone')
@@ -457,8 +442,7 @@ def set_right_none(self):
 
     driver_path = self.get_driver_path('right_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.right', 'setRightReactive', in_sig='yyyy')
@@ -496,8 +480,7 @@ def set_right_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightBreathRandom')
@@ -517,8 +500,7 @@ def set_right_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightBreathSingle', in_sig='yyy')
@@ -548,8 +530,7 @@ def set_right_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightBreathDual', in_sig='yyyyyy')
@@ -588,8 +569,7 @@ def set_right_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightWave', in_sig='i')
@@ -614,8 +594,7 @@ def set_backlight_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightStatic', in_sig='yyy')
@@ -645,8 +624,7 @@ def set_backlight_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightSpectrum')
@@ -664,8 +642,7 @@ def set_backlight_spectrum(self):
 
     effect_driver_path = self.get_driver_path('backlight_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightNone')
@@ -683,8 +660,7 @@ def set_backlight_none(self):
 
     driver_path = self.get_driver_path('backlight_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightOn')
@@ -702,8 +678,7 @@ def set_backlight_on(self):
 
     driver_path = self.get_driver_path('backlight_matrix_effect_on')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightReactive', in_sig='yyyy')
@@ -741,8 +716,7 @@ def set_backlight_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightBreathRandom')
@@ -762,8 +736,7 @@ def set_backlight_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightBreathSingle', in_sig='yyy')
@@ -793,8 +766,7 @@ def set_backlight_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightBreathDual', in_sig='yyyyyy')
@@ -833,5 +805,4 @@ def set_backlight_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
@@ -48,8 +48,7 @@ def set_idle_time(self, idle_time):
 
     driver_path = self.get_driver_path('device_idle_time')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(idle_time))
+    self.write_driver_file(driver_path, str(idle_time))
 
 
 @endpoint('razer.device.power', 'getIdleTime', out_sig='q')
@@ -85,8 +84,7 @@ def set_low_battery_threshold(self, threshold):
 
     threshold = math.floor((threshold / 100) * 255)
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(threshold))
+    self.write_driver_file(driver_path, str(threshold))
 
 
 @endpoint('razer.device.power', 'getLowBatteryThreshold', out_sig='y')
@@ -124,8 +122,7 @@ def set_charge_effect(self, charge_effect):
 
     driver_path = self.get_driver_path('charge_effect')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([charge_effect]))
+    self.write_driver_file(driver_path, bytes([charge_effect]))
 
 
 @endpoint('razer.device.lighting.power', 'setChargeColour', in_sig='yyy')
@@ -148,8 +145,7 @@ def set_charge_colour(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.dpi', 'setDPI', in_sig='qq')
@@ -199,8 +195,7 @@ def set_dpi_xy(self, dpi_x, dpi_y):
     self.set_persistence(None, "dpi_x", dpi_x)
     self.set_persistence(None, "dpi_y", dpi_y)
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(dpi_bytes)
+    self.write_driver_file(driver_path, dpi_bytes)
 
 
 @endpoint('razer.device.dpi', 'getDPI', out_sig='ai')
@@ -250,8 +245,7 @@ def set_dpi_stages(self, active_stage, dpi_stages):
     for dpi_x, dpi_y in dpi_stages:
         dpi_bytes += struct.pack('>HH', dpi_x, dpi_y)
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(dpi_bytes)
+    self.write_driver_file(driver_path, dpi_bytes)
 
 
 @endpoint('razer.device.dpi', 'getDPIStages', out_sig='(ya(qq))')
@@ -316,8 +310,7 @@ def set_poll_rate(self, rate):
     # remember poll rate
     self.poll_rate = rate
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(rate))
+    self.write_driver_file(driver_path, str(rate))
 
 
 @endpoint('razer.device.misc', 'getPollRate', out_sig='i')
@@ -361,8 +354,7 @@ def set_hyperpolling_wireless_dongle_indicator_led_mode(self, mode):
 
     driver_path = self.get_driver_path('hyperpolling_wireless_dongle_indicator_led_mode')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(mode))
+    self.write_driver_file(driver_path, str(mode))
 
 
 @endpoint('razer.device.misc', 'setHyperPollingPair', in_sig='s')
@@ -377,8 +369,7 @@ def set_hyperpolling_wireless_dongle_pair(self, pid):
 
     driver_path = self.get_driver_path('hyperpolling_wireless_dongle_pair')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(pid)
+    self.write_driver_file(driver_path, pid)
 
 
 @endpoint('razer.device.misc', 'setHyperPollingUnpair', in_sig='s')
@@ -393,5 +384,4 @@ def set_hyperpolling_wireless_dongle_unpair(self, pid):
 
     driver_path = self.get_driver_path('hyperpolling_wireless_dongle_unpair')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(pid)
+    self.write_driver_file(driver_path, pid)
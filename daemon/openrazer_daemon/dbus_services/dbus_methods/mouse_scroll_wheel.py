@@ -18,8 +18,7 @@ def set_scroll_mode(self, mode):
 
     driver_path = self.get_driver_path('scroll_mode')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(mode)))
+    self.write_driver_file(driver_path, str(int(mode)))
 
 
 @endpoint('razer.device.scroll', 'getScrollMode', out_sig='y')
@@ -50,8 +49,7 @@ def set_scroll_acceleration(self, enabled):
 
     driver_path = self.get_driver_path('scroll_acceleration')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(enabled)))
+    self.write_driver_file(driver_path, str(int(enabled)))
 
 
 @endpoint('razer.device.scroll', 'getScrollAcceleration', out_sig='b')
@@ -82,8 +80,7 @@ def set_scroll_smart_reel(self, enabled):
 
     driver_path = self.get_driver_path('scroll_smart_reel')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(enabled)))
+    self.write_driver_file(driver_path, str(int(enabled)))
 
 
 @endpoint('razer.device.scroll', 'getScrollSmartReel', out_sig='b')
@@ -46,14 +46,12 @@ def set_dpi_xy_byte(self, dpi_x, dpi_y):
     self.set_persistence(None, "dpi_y", dpi_y_scaled)
 
     if self._testing:
-        with open(driver_path, 'w') as driver_file:
-            driver_file.write("{}:{}".format(dpi_x_scaled, dpi_y_scaled))
+        self.write_driver_file(driver_path, "{}:{}".format(dpi_x_scaled, dpi_y_scaled))
         return
 
     dpi_bytes = struct.pack('>BB', dpi_x_scaled, dpi_y_scaled)
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(dpi_bytes)
+    self.write_driver_file(driver_path, dpi_bytes)
 
 
 @endpoint('razer.device.dpi', 'getDPI', out_sig='ai')
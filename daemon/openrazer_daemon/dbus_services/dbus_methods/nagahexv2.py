@@ -30,8 +30,7 @@ def set_logo_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoSpectrum')
@@ -49,8 +48,7 @@ def set_logo_spectrum(self):
 
     effect_driver_path = self.get_driver_path('logo_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoNone')
@@ -68,8 +66,7 @@ def set_logo_none(self):
 
     driver_path = self.get_driver_path('logo_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoOn')
@@ -87,8 +84,7 @@ def set_logo_on(self):
 
     driver_path = self.get_driver_path('logo_matrix_effect_on')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoReactive', in_sig='yyyy')
@@ -125,8 +121,7 @@ def set_logo_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathMono')
@@ -144,8 +139,7 @@ def set_logo_breath_mono(self):
 
     driver_path = self.get_driver_path('logo_matrix_effect_breath')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(b'1')
+    self.write_driver_file(driver_path, b'1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathRandom')
@@ -165,8 +159,7 @@ def set_logo_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathSingle', in_sig='yyy')
@@ -196,8 +189,7 @@ def set_logo_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathDual', in_sig='yyyyyy')
@@ -236,8 +228,7 @@ def set_logo_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBlinking', in_sig='yyy')
@@ -267,8 +258,7 @@ def set_logo_blinking(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollStatic', in_sig='yyy')
@@ -298,8 +288,7 @@ def set_scroll_static(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollSpectrum')
@@ -316,8 +305,7 @@ def set_scroll_spectrum(self):
 
     effect_driver_path = self.get_driver_path('scroll_matrix_effect_spectrum')
 
-    with open(effect_driver_path, 'w') as effect_driver_file:
-        effect_driver_file.write('1')
+    self.write_driver_file(effect_driver_path, '1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollNone')
@@ -334,8 +322,7 @@ def set_scroll_none(self):
 
     driver_path = self.get_driver_path('scroll_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollOn')
@@ -352,8 +339,7 @@ def set_scroll_on(self):
 
     driver_path = self.get_driver_path('scroll_matrix_effect_on')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollReactive', in_sig='yyyy')
@@ -390,8 +376,7 @@ def set_scroll_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathMono')
@@ -409,8 +394,7 @@ def set_scroll_breath_mono(self):
 
     driver_path = self.get_driver_path('scroll_matrix_effect_breath')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(b'1')
+    self.write_driver_file(driver_path, b'1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathRandom')
@@ -430,8 +414,7 @@ def set_scroll_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathSingle', in_sig='yyy')
@@ -461,8 +444,7 @@ def set_scroll_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathDual', in_sig='yyyyyy')
@@ -501,8 +483,7 @@ def set_scroll_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBlinking', in_sig='yyy')
@@ -532,5 +513,4 @@ def set_scroll_blinking(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(rgb_driver_path, 'wb') as rgb_driver_file:
-        rgb_driver_file.write(payload)
+    self.write_driver_file(rgb_driver_path, payload)
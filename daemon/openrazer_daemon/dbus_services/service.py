@@ -31,6 +31,29 @@ def copy_func(function_reference, name=None):
         return types.FunctionType(function_reference.__code__, function_reference.__globals__, name or function_reference.func_name, function_reference.__defaults__, function_reference.__closure__)
 
 
+def get_class_key(cls, class_table):
+    """
+    Get the key of a class in the DBus introspection table
+
+    dbus-python keys the table by module and class name, the suffix search is
+    only a fallback.
+
+    :param cls: Class
+    :type cls: type
+
+    :param class_table: DBus class table
+    :type class_table: dict
+
+    :return: Key
+    :rtype: str
+    """
+    class_key = cls.__module__ + '.' + cls.__name__
+    if class_key not in class_table:
+        class_key = [key for key in class_table.keys() if key.endswith(cls.__name__)][0]
+
+    return class_key
+
+
 class DBusService(dbus.service.Object):
     """
     DBus Service object
@@ -79,12 +102,20 @@ class DBusService(dbus.service.Object):
         :type byte_arrays: bool
         """
 
+        # Methods are added to the class, so every device of a class shares them
+        # and only the first one has to build them
+        source = getattr(function, '__func__', function)
+        registered = self.__class__.__dict__.get(function_name)
+        if registered is not None and getattr(registered, '_dbus_source', None) is source and registered._dbus_interface == interface_name:
+            return
+
         # Get class key for use in the DBus introspection table
-        class_key = [key for key in self._dbus_class_table.keys() if key.endswith(self.__class__.__name__)][0]
+        class_key = get_class_key(self.__class__, self._dbus_class_table)
 
         # Create a copy of the function so that if its used multiple times it won't affect other instances if the names changed
         function_deepcopy = copy_func(function, function_name)
         func = dbus.service.method(interface_name, in_signature=in_signature, out_signature=out_signature, byte_arrays=byte_arrays)(function_deepcopy)
+        func._dbus_source = source
 
         # Add method to DBus tables
         try:
@@ -107,13 +138,13 @@ class DBusService(dbus.service.Object):
         """
 
         # Get class key for use in the DBus introspection table
-        class_key = [key for key in self._dbus_class_table.keys() if key.endswith(self.__class__.__name__)][0]
+        class_key = get_class_key(self.__class__, self._dbus_class_table)
 
         # Remove method from DBus tables
         # Remove method from class
         try:
             del self._dbus_class_table[class_key][interface_name][function_name]
-            delattr(DBusService, function_name)
+            delattr(self.__class__, function_name)
 
         except (KeyError, AttributeError):
             pass
@@ -4,6 +4,9 @@
 Class to hold a device and collections of them
 """
 
+# Synced effects that don't replace the lighting effect of a device
+SYNC_SEPARATE = ('setBrightness', 'triggerReactive', 'setSize')
+
 
 class Device(object):
     """
@@ -74,8 +77,15 @@ class Device(object):
         :param msg: Tuple with first element a string
         :type msg: tuple
         """
-        # Message from DBus object
-        self._dbus.notify(msg)
+        # Effects are applied on the device's writer thread, so synced devices change together
+        # instead of one after another. A pending effect is replaced by any newer one, brightness
+        # and the like don't replace the effect and only replace their own kind. An effect set over
+        # DBus cancels the synced ones still pending, so it isn't overwritten by an older one.
+        if isinstance(msg, tuple) and msg[0] == 'effect':
+            kind = msg[2] if msg[2] in SYNC_SEPARATE else 'effect'
+            self._dbus.queue_write(('effect_sync', kind), self._dbus.notify, msg)
+        else:
+            self._dbus.notify(msg)
 
 
 class DeviceCollection(object):
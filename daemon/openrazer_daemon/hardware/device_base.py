@@ -11,12 +11,23 @@ import inspect
 import logging
 import time
 import json
+import threading
 from typing import Optional
 
 from openrazer_daemon.dbus_services.service import DBusService
 import openrazer_daemon.dbus_services.dbus_methods
 from openrazer_daemon.misc import effect_sync
 from openrazer_daemon.misc.battery_notifier import BatteryManager as _BatteryManager
+from openrazer_daemon.misc.driver_files import DriverFileCache
+from openrazer_daemon.misc.frame_stream import FrameStream
+from openrazer_daemon.misc.frame_ring import FrameRing
+from openrazer_daemon.misc.device_writer import DeviceWriter
+
+# Devices are set up in parallel, guards the shared unknown serial counter
+_unknown_serial_lock = threading.Lock()
+
+# DBus endpoints in dbus_methods by function name, resolved once for all devices
+_available_functions = None
 
 
 # pylint: disable=too-many-instance-attributes
@@ -48,7 +59,7 @@ class RazerDevice(DBusService):
 
     DEVICE_IMAGE: Optional[str] = None
 
-    def __init__(self, device_path, device_number, config, persistence, testing, additional_interfaces, additional_methods, unknown_serial_counter):
+    def __init__(self, device_path, device_number, config, persistence, testing, additional_interfaces, additional_methods, unknown_serial_counter, device_cache=None):
 
         self.logger = logging.getLogger('razer.device{0}'.format(device_number))
         self.logger.info("Initialising device.%d %s", device_number, self.__class__.__name__)
@@ -64,7 +75,8 @@ class RazerDevice(DBusService):
 
         self._observer_list = []
         self._effect_sync_propagate_up = False
-        self._disable_notifications = False
+        # Per thread, effect sync applies effects on the writer thread while DBus calls come in on the main loop
+        self._disable_notifications = threading.local()
         self._disable_persistence = False
         self.additional_interfaces = []
         if additional_interfaces is not None:
@@ -77,6 +89,16 @@ class RazerDevice(DBusService):
         self._parent = None
         self._device_path = device_path
         self._device_number = device_number
+        # The fake driver's files are regular files, which keep the tail of a longer previous write
+        self._driver_files = DriverFileCache(truncate=testing)
+        self._frame_stream = None
+        self._frame_ring = None
+        self._writer_lock = threading.Lock()
+        self._writer = None
+        # The USB descriptor of a device behind a receiver is the receiver's, it doesn't
+        # tell the devices paired with it apart. Every device that can be wireless has a battery.
+        self._device_cache = device_cache if 'get_battery' not in self.METHODS else None
+        self._static_info = {}
         self.serial = self.get_serial()
 
         if self.USB_PID == 0x0f07:
@@ -123,6 +145,12 @@ class RazerDevice(DBusService):
         self.methods_internal = ['get_firmware', 'get_matrix_dims', 'has_matrix', 'get_device_name']
         self.methods_internal.extend(additional_methods)
 
+        # Devices taking custom frames can also have them streamed over a socket
+        if 'set_key_row' in self.METHODS:
+            self.methods_internal.append('open_frame_stream')
+            if self.MATRIX_DIMS:
+                self.methods_internal.append('open_frame_ring')
+
         # Find event files in /dev/input/by-id/ by matching against regex
         self.event_files = []
 
@@ -251,74 +279,76 @@ class RazerDevice(DBusService):
         # Load additional DBus methods
         self.load_methods()
 
-        # load last DPI/poll rate state
-        if self.persistence.has_section(self.storage_name):
-            if 'set_dpi_xy' in self.METHODS or 'set_dpi_xy_byte' in self.METHODS:
-                try:
-                    self.dpi[0] = int(self.persistence[self.storage_name]['dpi_x'])
-                    self.dpi[1] = int(self.persistence[self.storage_name]['dpi_y'])
-                except (KeyError, configparser.NoOptionError):
-                    self.logger.info("Failed to get DPI from persistence storage, using default.")
-
-            if 'set_poll_rate' in self.METHODS:
-                try:
-                    self.poll_rate = int(self.persistence[self.storage_name]['poll_rate'])
-                except (KeyError, configparser.NoOptionError):
-                    self.logger.info("Failed to get poll rate from persistence storage, using default.")
-
-        # load last effects
-        for i in self.ZONES:
-            if self.zone[i]["present"]:
-                # check if we have the device in the persistence file
-                if self.persistence.has_section(self.storage_name):
-                    # try reading the effect name from the persistence
-                    try:
-                        self.zone[i]["effect"] = self.persistence[self.storage_name][i + '_effect']
-                    except (KeyError, configparser.NoOptionError):
-                        self.logger.info("Failed to get " + i + " effect from persistence storage, using default.")
-
-                    # zone active status
-                    try:
-                        self.zone[i]["active"] = self.persistence.getboolean(self.storage_name, i + '_active')
-                    except (KeyError, configparser.NoOptionError):
-                        self.logger.info("Failed to get " + i + " active from persistence storage, using default.")
-
-                    # brightness
-                    try:
-                        self.zone[i]["brightness"] = float(self.persistence[self.storage_name][i + '_brightness'])
-                    except (KeyError, configparser.NoOptionError):
-                        self.logger.info("Failed to get " + i + " brightness from persistence storage, using default.")
-
-                    # colors.
-                    # these are stored as a string that must contain 9 numbers, separated with spaces.
-                    try:
-                        for index, item in enumerate(self.persistence[self.storage_name][i + '_colors'].split(" ")):
-                            self.zone[i]["colors"][index] = int(item)
-                            # check if the color is in range
-                            if not 0 <= self.zone[i]["colors"][index] <= 255:
-                                raise ValueError('Color out of range')
-
-                        # check if we have exactly 9 colors
-                        if len(self.zone[i]["colors"]) != 9:
-                            raise ValueError('There must be exactly 9 colors')
-                    except ValueError:
-                        # invalid colors. reinitialize
-                        self.zone[i]["colors"] = [0, 255, 0, 0, 255, 255, 0, 0, 255]
-                        self.logger.info("%s: Invalid colors; restoring to defaults.", self.__class__.__name__)
-                    except (KeyError, configparser.NoOptionError):
-                        self.logger.info("Failed to get " + i + " colors from persistence storage, using default.")
-
-                    # speed
+        # Devices are set up in parallel and the autosave thread writes to it
+        with self.persistence.lock:
+            # load last DPI/poll rate state
+            if self.persistence.has_section(self.storage_name):
+                if 'set_dpi_xy' in self.METHODS or 'set_dpi_xy_byte' in self.METHODS:
                     try:
-                        self.zone[i]["speed"] = int(self.persistence[self.storage_name][i + '_speed'])
+                        self.dpi[0] = int(self.persistence[self.storage_name]['dpi_x'])
+                        self.dpi[1] = int(self.persistence[self.storage_name]['dpi_y'])
                     except (KeyError, configparser.NoOptionError):
-                        self.logger.info("Failed to get " + i + " speed from persistence storage, using default.")
+                        self.logger.info("Failed to get DPI from persistence storage, using default.")
 
-                    # wave direction
+                if 'set_poll_rate' in self.METHODS:
                     try:
-                        self.zone[i]["wave_dir"] = int(self.persistence[self.storage_name][i + '_wave_dir'])
+                        self.poll_rate = int(self.persistence[self.storage_name]['poll_rate'])
                     except (KeyError, configparser.NoOptionError):
-                        self.logger.info("Failed to get " + i + " wave direction from persistence storage, using default.")
+                        self.logger.info("Failed to get poll rate from persistence storage, using default.")
+
+            # load last effects
+            for i in self.ZONES:
+                if self.zone[i]["present"]:
+                    # check if we have the device in the persistence file
+                    if self.persistence.has_section(self.storage_name):
+                        # try reading the effect name from the persistence
+                        try:
+                            self.zone[i]["effect"] = self.persistence[self.storage_name][i + '_effect']
+                        except (KeyError, configparser.NoOptionError):
+                            self.logger.info("Failed to get " + i + " effect from persistence storage, using default.")
+
+                        # zone active status
+                        try:
+                            self.zone[i]["active"] = self.persistence.getboolean(self.storage_name, i + '_active')
+                        except (KeyError, configparser.NoOptionError):
+                            self.logger.info("Failed to get " + i + " active from persistence storage, using default.")
+
+                        # brightness
+                        try:
+                            self.zone[i]["brightness"] = float(self.persistence[self.storage_name][i + '_brightness'])
+                        except (KeyError, configparser.NoOptionError):
+                            self.logger.info("Failed to get " + i + " brightness from persistence storage, using default.")
+
+                        # colors.
+                        # these are stored as a string that must contain 9 numbers, separated with spaces.
+                        try:
+                            for index, item in enumerate(self.persistence[self.storage_name][i + '_colors'].split(" ")):
+                                self.zone[i]["colors"][index] = int(item)
+                                # check if the color is in range
+                                if not 0 <= self.zone[i]["colors"][index] <= 255:
+                                    raise ValueError('Color out of range')
+
+                            # check if we have exactly 9 colors
+                            if len(self.zone[i]["colors"]) != 9:
+                                raise ValueError('There must be exactly 9 colors')
+                        except ValueError:
+                            # invalid colors. reinitialize
+                            self.zone[i]["colors"] = [0, 255, 0, 0, 255, 255, 0, 0, 255]
+                            self.logger.info("%s: Invalid colors; restoring to defaults.", self.__class__.__name__)
+                        except (KeyError, configparser.NoOptionError):
+                            self.logger.info("Failed to get " + i + " colors from persistence storage, using default.")
+
+                        # speed
+                        try:
+                            self.zone[i]["speed"] = int(self.persistence[self.storage_name][i + '_speed'])
+                        except (KeyError, configparser.NoOptionError):
+                            self.logger.info("Failed to get " + i + " speed from persistence storage, using default.")
+
+                        # wave direction
+                        try:
+                            self.zone[i]["wave_dir"] = int(self.persistence[self.storage_name][i + '_wave_dir'])
+                        except (KeyError, configparser.NoOptionError):
+                            self.logger.info("Failed to get " + i + " wave direction from persistence storage, using default.")
 
         # Initialize battery manager if the device has support
         if 'get_battery' in self.METHODS:
@@ -356,6 +386,13 @@ class RazerDevice(DBusService):
         :param args: Effect arguments
         :type args: list
         """
+        # Queued custom frames would overwrite the new effect. cancel() also waits for a frame
+        # being written, so the effect written after this lands last. On the writer thread
+        # itself (a synced effect) everything still queued is newer, so keep it.
+        if self._writer is not None and effect_name not in ('setCustom', 'setBrightness', 'triggerReactive') \
+                and threading.current_thread() is not self._writer:
+            self._writer.cancel()
+
         payload = ['effect', self, effect_name]
         payload.extend(args)
 
@@ -540,7 +577,7 @@ class RazerDevice(DBusService):
             return
         self.logger.debug("Set persistence (%s, %s, %s)", zone, key, value)
 
-        self.persistence.status["changed"] = True
+        self.persistence.autosave.mark_changed(self.storage_name)
 
         if zone:
             self.zone[zone][key] = value
@@ -927,7 +964,7 @@ class RazerDevice(DBusService):
         :return: Flag
         :rtype: bool
         """
-        return self._disable_notifications
+        return getattr(self._disable_notifications, 'value', False)
 
     @disable_notify.setter
     def disable_notify(self, value):
@@ -937,7 +974,7 @@ class RazerDevice(DBusService):
         :param value: Disable
         :type value: bool
         """
-        self._disable_notifications = value
+        self._disable_notifications.value = value
 
     @property
     def disable_persistence(self):
@@ -971,6 +1008,42 @@ class RazerDevice(DBusService):
         """
         return os.path.join(self._device_path, driver_filename)
 
+    def get_static_info(self, key, read_func):
+        """
+        Get info that doesn't change while the device is plugged in, like the firmware version
+
+        The value is read once per device. It isn't kept in the device cache, a firmware
+        update doesn't have to change anything in the USB descriptor the cache checks against.
+
+        :param key: Name of the value
+        :type key: str
+
+        :param read_func: Function reading the value from the device
+        :type read_func: callable
+
+        :return: Value
+        """
+        value = self._static_info.get(key)
+        if value is None:
+            value = self._static_info[key] = read_func()
+
+        return value
+
+    def write_driver_file(self, driver_path, payload):
+        """
+        Write to a driver file, keeping it open for the next write
+
+        :param driver_path: Full path to driver file
+        :type driver_path: str
+
+        :param payload: Data to write, strings are ASCII encoded
+        :type payload: str or bytes
+        """
+        if isinstance(payload, str):
+            payload = payload.encode('ascii')
+
+        self._driver_files.write(driver_path, payload)
+
     def get_serial(self):
         """
         Get serial number for device
@@ -979,6 +1052,11 @@ class RazerDevice(DBusService):
         :rtype: str
         """
         # TODO raise exception if serial can't be got and handle during device add
+        if self._serial is None and self._device_cache is not None:
+            self._serial = self._device_cache.lookup_serial(self._device_path, self.__class__.__name__)
+            if self._serial is not None:
+                self.logger.debug("Using cached serial %s", self._serial)
+
         if self._serial is None:
             serial_path = os.path.join(self._device_path, 'device_serial')
             count = 0
@@ -1013,9 +1091,12 @@ class RazerDevice(DBusService):
                 self.logger.warning("Invalid serial number found, using a generated one.")
                 self.logger.warning("Original value: %s" % serial)
                 vid, pid = self.get_vid_pid()
-                idx = self._unknown_serial_counter.get((vid, pid), 0)
-                self._unknown_serial_counter[(vid, pid)] = idx + 1
+                with _unknown_serial_lock:
+                    idx = self._unknown_serial_counter.get((vid, pid), 0)
+                    self._unknown_serial_counter[(vid, pid)] = idx + 1
                 serial = "UNKNOWN_{0:04X}{1:04X}_{2:04d}".format(vid, pid, idx)
+            elif self._device_cache is not None:
+                self._device_cache.set(serial.replace(' ', '_'), self._device_path, self.__class__.__name__, 'serial', True)
 
             self._serial = serial.replace(' ', '_')
 
@@ -1053,15 +1134,14 @@ class RazerDevice(DBusService):
         :type param: int
         """
         device_mode_path = os.path.join(self._device_path, 'device_mode')
-        with open(device_mode_path, 'wb') as mode_file:
 
-            # Do some validation (even though its in the driver)
-            if mode_id not in (0, 3):
-                mode_id = 0
-            if param != 0:
-                param = 0
+        # Do some validation (even though its in the driver)
+        if mode_id not in (0, 3):
+            mode_id = 0
+        if param != 0:
+            param = 0
 
-            mode_file.write(bytes([mode_id, param]))
+        self.write_driver_file(device_mode_path, bytes([mode_id, param]))
 
     def _set_custom_effect(self):
         """
@@ -1071,10 +1151,7 @@ class RazerDevice(DBusService):
 
         driver_path = self.get_driver_path('matrix_effect_custom')
 
-        payload = b'1'
-
-        with open(driver_path, 'wb') as driver_file:
-            driver_file.write(payload)
+        self.write_driver_file(driver_path, b'1')
 
     def _set_key_row(self, payload):
         """
@@ -1093,8 +1170,85 @@ class RazerDevice(DBusService):
 
         driver_path = self.get_driver_path('matrix_custom_frame')
 
-        with open(driver_path, 'wb') as driver_file:
-            driver_file.write(payload)
+        self.write_driver_file(driver_path, payload)
+
+    def queue_write(self, key, func, *args):
+        """
+        Run a driver write on the device's writer thread
+
+        A write queued under the key of a pending write replaces it.
+
+        :param key: Key to coalesce writes on
+        :type key: tuple
+
+        :param func: Function doing the write
+        :type func: callable
+
+        :param args: Arguments for func
+        :type args: list
+        """
+        with self._writer_lock:
+            if self._writer is None:
+                self._writer = DeviceWriter(self._device_number)
+                self._writer.start()
+
+        self._writer.submit(key, func, *args)
+
+    @staticmethod
+    def _key_row_key(payload):
+        """
+        Get the key for coalescing setKeyRow payloads, based on the rows and columns they cover
+
+        :param payload: Binary payload
+        :type payload: bytes
+
+        :return: Key
+        :rtype: tuple
+        """
+        rows = []
+        offset = 0
+        while offset + 3 <= len(payload):
+            row, start, stop = payload[offset:offset + 3]
+            if stop < start:
+                # Let the driver complain about it
+                return ('set_key_row', bytes(payload))
+
+            rows.append((row, start, stop))
+            offset += 3 + (stop - start + 1) * 3
+
+        return ('set_key_row',) + tuple(rows)
+
+    def _open_frame_stream(self):
+        """
+        Start a new frame stream, replacing the previous one
+
+        :return: Client end of the stream socket
+        :rtype: int
+        """
+        if self._frame_stream is not None:
+            self._frame_stream.close()
+
+        self._frame_stream = FrameStream(self, self._device_number)
+        client_fd = self._frame_stream.take_client_fd()
+        self._frame_stream.start()
+
+        return client_fd
+
+    def _open_frame_ring(self):
+        """
+        Start a new shared memory frame ring, replacing the previous one
+
+        :return: Shared memory and eventfd of the ring
+        :rtype: tuple
+        """
+        if self._frame_ring is not None:
+            self._frame_ring.close()
+
+        rows, cols = self.MATRIX_DIMS
+        self._frame_ring = FrameRing(self, self._device_number, rows * (3 + cols * 3))
+        self._frame_ring.start()
+
+        return self._frame_ring.memfd, self._frame_ring.eventfd
 
     def _init_battery_manager(self):
         """
@@ -1132,12 +1286,16 @@ class RazerDevice(DBusService):
 
         Goes through the list in self.methods_internal and self.METHODS and loads each effect and adds it to DBus
         """
-        available_functions = {}
-        methods = dir(openrazer_daemon.dbus_services.dbus_methods)
-        for method in methods:
-            potential_function = getattr(openrazer_daemon.dbus_services.dbus_methods, method)
-            if isinstance(potential_function, types.FunctionType) and hasattr(potential_function, 'endpoint') and potential_function.endpoint:
-                available_functions[potential_function.__name__] = potential_function
+        global _available_functions  # pylint: disable=global-statement
+        if _available_functions is None:
+            available_functions = {}
+            methods = dir(openrazer_daemon.dbus_services.dbus_methods)
+            for method in methods:
+                potential_function = getattr(openrazer_daemon.dbus_services.dbus_methods, method)
+                if isinstance(potential_function, types.FunctionType) and hasattr(potential_function, 'endpoint') and potential_function.endpoint:
+                    available_functions[potential_function.__name__] = potential_function
+            _available_functions = available_functions
+        available_functions = _available_functions
 
         self.methods_internal.extend(self.METHODS)
         for method_name in self.methods_internal:
@@ -1207,6 +1365,17 @@ class RazerDevice(DBusService):
         if self._battery_manager:
             self._battery_manager.close()
 
+        if self._frame_stream is not None:
+            self._frame_stream.close()
+
+        if self._frame_ring is not None:
+            self._frame_ring.close()
+
+        if self._writer is not None:
+            self._writer.close()
+
+        self._driver_files.close()
+
     def close(self):
         """
         Close any resources opened by subclasses
@@ -1269,7 +1438,7 @@ class RazerDevice(DBusService):
         :param msg: Tuple with first element a string
         :type msg: tuple
         """
-        if not self._disable_notifications:
+        if not self.disable_notify:
             self.logger.debug("Sending observer message: %s", str(msg))
 
             if self._effect_sync_propagate_up and self._parent is not None:
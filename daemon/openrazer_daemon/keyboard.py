@@ -4,7 +4,6 @@
 Module to handle custom colours
 """
 
-import struct
 import subprocess
 
 
@@ -405,20 +404,34 @@ class RGB(object):
 class KeyboardColour(object):
     """
     Keyboard class which represents the colour state of the keyboard.
+
+    The colours live in one buffer in driver format. Each row is the row ID,
+    start and end column, then RGB per column, so the buffer can be written
+    to the driver as it is.
     """
 
     def __init__(self, rows, columns):
         self.rows = rows
         self.columns = columns
 
-        # Two-dimensional array to hold color data
-        self.colors = []
+        self._row_size = 3 + columns * 3
+
+        # Empty keyboard with the row headers filled in, copied over the buffer on reset
+        self._blank = bytearray(rows * self._row_size)
+        for row in range(0, rows):
+            self._blank[row * self._row_size:row * self._row_size + 3] = bytes((row, 0x00, columns - 1))
+
+        self._buffer = bytearray(self._blank)
+        self._view = memoryview(self._buffer)
 
         # Backup object (currently not used)
         self.backup = None
 
-        # Initialize array with empty values
-        self.reset_rows()
+    def _offset(self, row, col):
+        if not 0 <= row < self.rows or not 0 <= col < self.columns:
+            raise IndexError("Key ({0}, {1}) is outside of the matrix".format(row, col))
+
+        return row * self._row_size + 3 + col * 3
 
     def backup_configuration(self):
         """
@@ -434,7 +447,7 @@ class KeyboardColour(object):
         if self.backup is None:
             raise NoBackupError()
 
-        self.colors = self.backup.colors
+        self._buffer[:] = self.backup._buffer
         self.backup = None
 
     def get_rows_raw(self):
@@ -444,17 +457,13 @@ class KeyboardColour(object):
         :return: Rows
         :rtype: list
         """
-        return self.colors
+        return [[RGB(*self._buffer[self._offset(row, col):self._offset(row, col) + 3]) for col in range(0, self.columns)] for row in range(0, self.rows)]
 
     def reset_rows(self):
         """
         Reset the rows of the keyboard
         """
-        self.colors.clear()
-
-        for row in range(0, self.rows):
-            # Create 22 rgb values
-            self.colors.append([RGB() for _ in range(0, self.columns)])
+        self._buffer[:] = self._blank
 
     def set_key_colour(self, row, col, colour):
         """
@@ -471,7 +480,11 @@ class KeyboardColour(object):
 
         :raises KeyDoesNotExistError: If given key does not exist
         """
-        self.colors[row][col].set(colour)
+        offset = self._offset(row, col)
+
+        self._buffer[offset] = RGB.clamp(colour[0])
+        self._buffer[offset + 1] = RGB.clamp(colour[1])
+        self._buffer[offset + 2] = RGB.clamp(colour[2])
 
     def get_key_colour(self, key):
         """
@@ -486,7 +499,8 @@ class KeyboardColour(object):
             raise KeyDoesNotExistError("The key \"{0}\" does not exist".format(key))
 
         row_id, col_id = KEY_MAPPING[key]
-        return self.colors[row_id][col_id].get()
+        offset = self._offset(row_id, col_id)
+        return tuple(self._buffer[offset:offset + 3])
 
     def reset_key(self, row, col):
         """
@@ -500,58 +514,46 @@ class KeyboardColour(object):
 
         :raises KeyDoesNotExistError: If given key does not exist
         """
-        self.colors[row][col].set((0, 0, 0))
+        self.set_key_colour(row, col, (0, 0, 0))
 
     def get_row_binary(self, row_id):
         """
         Gets the binary payload for a given row
 
+        The view stays valid and follows later colour changes.
+
         :param row_id: Row ID
         :type row_id: int
 
-        :return: Byte string of 67 bytes, Row ID byte then 22 RGB bytes
-        :rtype: bytearray
+        :return: View of 67 bytes, Row ID byte, start and end column then 22 RGB bytes
+        :rtype: memoryview
         """
         assert isinstance(row_id, int), "Row ID is not an int"
 
-        payload = bytes([row_id, 0x00, len(self.colors[row_id]) - 1])
-
-        for rgb in self.colors[row_id]:
-            payload += bytes(rgb)
-
-        return payload
+        return self._view[row_id * self._row_size:(row_id + 1) * self._row_size]
 
     def get_total_binary(self):
         """
         Gets the binary payload for the whole keyboard
 
-        :return: Byte string of 6*67 bytes, (Row ID byte then 22 RGB bytes) * 6
-        :rtype: bytearray
-        """
-        payload = b''
-
-        for row in range(0, self.rows):
-            payload += self.get_row_binary(row)
+        The view stays valid and follows later colour changes.
 
-        return payload
+        :return: View of 6*67 bytes, (Row ID byte, start and end column then 22 RGB bytes) * 6
+        :rtype: memoryview
+        """
+        return self._view
 
     def get_from_total_binary(self, binary_blob):
         """
         Load in a binary blob which is the output from get_total_binary
 
         :param binary_blob: Binary blob
-        :type binary_blob: bytearray
+        :type binary_blob: bytes or memoryview
         """
-        self.reset_rows()
-
-        for row_id in range(0, self.rows):
-            binary_blob = binary_blob[1:]  # Skip first byte
-
-            for col_id, binary_rgb in enumerate([binary_blob[i:i + 3] for i in range(0, 66, 3)]):
-                rgb = struct.unpack('=BBB', binary_rgb)
-                self.colors[row_id][col_id].set(rgb)
+        if len(binary_blob) != len(self._buffer):
+            raise ValueError("Expected {0} bytes, got {1}".format(len(self._buffer), len(binary_blob)))
 
-            binary_blob = binary_blob[66:]  # Skip the current row
+        self._buffer[:] = binary_blob
 
 
 def get_keyboard_layout():
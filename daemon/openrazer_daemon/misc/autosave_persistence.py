@@ -3,10 +3,11 @@
 """
 A class that writes persistence data to disk when device state is updated.
 
-Due to the architecture of the daemon, it's not as simple to know when
-something has changed, so for now, an interval will periodically check for
-changes in memory and write them to disk. This also avoids excessive
-writes when lots of variables change at once.
+Devices signal which of their sections changed, the thread then waits for
+changes to settle before writing. That way a client changing effects many
+times a second causes one write instead of dozens, while max_delay bounds
+how long a change can stay unwritten. Nothing wakes up while nothing
+changes.
 
 This is essential because many desktop environments actually kill off
 the daemon upon logout/shutdown, thereby persistence isn't retained across
@@ -15,24 +16,86 @@ sessions.
 A known issue is that this doesn't monitor DPI changes via hardware buttons,
 so this won't be persisted until the state is updated via the API.
 """
+import threading
 import time
 
 
-class PersistenceAutoSave(object):
-    def __init__(self, persistence, persistence_file, persistence_status, logger, interval, persistence_save_fn):
-        self.persistence = persistence
+class PersistenceAutoSave(threading.Thread):
+    """
+    Thread writing changed persistence sections to disk
+    """
+
+    def __init__(self, persistence_file, logger, delay, max_delay, persistence_save_fn):
+        super().__init__(name='persistence-autosave', daemon=True)
         self.persistence_file = persistence_file
-        self.persistence_status = persistence_status
         self.persistence_save_fn = persistence_save_fn
         self.logger = logger
-        self.interval = interval
+        self.delay = delay
+        self.max_delay = max_delay
+
+        self._cond = threading.Condition()
+        self._dirty = set()
+        self._first_change = None
+        self._last_change = None
+        self._shutdown = False
+
+    def mark_changed(self, section):
+        """
+        Signal that a section changed and has to be written
 
-    def watch(self):
-        # Run indefinitely until process is terminated
+        :param section: Storage name of the device
+        :type section: str
+        """
+        with self._cond:
+            now = time.monotonic()
+            if not self._dirty:
+                self._first_change = now
+            self._last_change = now
+            self._dirty.add(section)
+            self._cond.notify()
+
+    def _take_dirty(self):
+        sections = self._dirty
+        self._dirty = set()
+        return sections
+
+    def run(self):
         while True:
-            time.sleep(self.interval)
+            with self._cond:
+                while not self._dirty and not self._shutdown:
+                    self._cond.wait()
+
+                if self._shutdown:
+                    break
+
+                # Wait until changes settle, but not longer than max_delay
+                while not self._shutdown:
+                    deadline = min(self._last_change + self.delay, self._first_change + self.max_delay)
+                    timeout = deadline - time.monotonic()
+                    if timeout <= 0:
+                        break
+                    self._cond.wait(timeout)
+
+                if self._shutdown:
+                    break
+
+                sections = self._take_dirty()
+
+            self.logger.debug("State recently changed, writing to disk")
+            try:
+                self.persistence_save_fn(self.persistence_file, sections)
+            except OSError as err:
+                self.logger.error("Failed to write persistence: %s", err)
+            except Exception:
+                self.logger.exception("Failed to write persistence")
+
+    def close(self):
+        """
+        Stop the thread, changes not written yet are left to the caller
+        """
+        with self._cond:
+            self._shutdown = True
+            self._cond.notify()
 
-            if self.persistence_status["changed"]:
-                self.logger.debug("State recently changed, writing to disk")
-                self.persistence_status["changed"] = False
-                self.persistence_save_fn(self.persistence_file)
+        if self.is_alive() and threading.current_thread() is not self:
+            self.join()
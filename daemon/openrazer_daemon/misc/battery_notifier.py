@@ -4,6 +4,8 @@
 This will do until I can be bothered to create indicator applet to do battery level
 """
 import logging
+import os
+import select
 import threading
 import datetime
 import time
@@ -13,6 +15,10 @@ import subprocess
 class BatteryNotifier(threading.Thread):
     """
     Thread to notify about battery
+
+    The drivers sysfs_notify() charge_level when it changes, so the thread
+    sleeps in poll() until the level changes, the next notification is due
+    or it's woken up for a settings change or shutdown.
     """
 
     def __init__(self, parent, device_id, device_name):
@@ -31,6 +37,16 @@ class BatteryNotifier(threading.Thread):
 
         self._last_notify_time = datetime.datetime(1970, 1, 1)
 
+        # Written to on shutdown and settings changes to wake the thread up
+        self._wakeup_fd = os.eventfd(0, os.EFD_CLOEXEC | os.EFD_NONBLOCK)
+
+        try:
+            self._level_fd = os.open(parent.get_driver_path('charge_level'), os.O_RDONLY | os.O_CLOEXEC)
+        except OSError:
+            self._level_fd = None
+        self._level = None
+        self._poll_object = None
+
     @property
     def shutdown(self):
         """
@@ -47,6 +63,14 @@ class BatteryNotifier(threading.Thread):
         :type value: bool
         """
         self._shutdown = value
+        self.wake()
+
+    def wake(self):
+        """
+        Make the thread look at its settings again
+        """
+        if self._wakeup_fd is not None:
+            os.eventfd_write(self._wakeup_fd, 1)
 
     def show_notification(self, summary: str, message: str, icon: str) -> None:
         try:
@@ -97,19 +121,80 @@ class BatteryNotifier(threading.Thread):
             if battery_level <= self.percent:
                 self.show_notification(summary=title, message=message, icon=icon)
 
+    def _read_level(self):
+        """
+        Read charge_level, which also re-arms the sysfs notification
+
+        :return: Battery level in percent or None if it's unknown
+        :rtype: float or None
+        """
+        os.lseek(self._level_fd, 0, os.SEEK_SET)
+        level = int(os.read(self._level_fd, 16).strip() or -1)
+        if level < 0:
+            return None
+
+        return (level / 255) * 100
+
+    def _level_changed(self):
+        """
+        Notify right away when the level drops to the threshold
+        """
+        try:
+            level = self._read_level()
+        except (OSError, ValueError):
+            # The device went away, fall back to the notification frequency
+            self._poll_object.unregister(self._level_fd)
+            return
+
+        if level is not None and self._level is not None and level <= self.percent < self._level:
+            self._last_notify_time = datetime.datetime(1970, 1, 1)
+        self._level = level
+
     def run(self):
         """
         Main thread function
         """
+        self._poll_object = select.poll()
+        self._poll_object.register(self._wakeup_fd, select.POLLIN)
+
+        if self._level_fd is not None:
+            try:
+                self._level = self._read_level()
+                self._poll_object.register(self._level_fd, select.POLLPRI | select.POLLERR)
+            except (OSError, ValueError):
+                pass
 
         while not self._shutdown:
+            timeout = None
             if self.event.is_set() and self.frequency > 0:
                 self.notify_battery()
 
-            time.sleep(0.1)
+                next_notify = self.frequency - (datetime.datetime.now() - self._last_notify_time).total_seconds()
+                timeout = max(next_notify, 1) * 1000
+
+            try:
+                events = self._poll_object.poll(timeout)
+            except InterruptedError:
+                continue
+
+            for fd, _ in events:
+                if fd == self._wakeup_fd:
+                    os.eventfd_read(self._wakeup_fd)
+                else:
+                    self._level_changed()
 
         self._logger.debug("Shutting down battery notifier")
 
+    def close(self):
+        """
+        Close the files once the thread is gone
+        """
+        for fd in (self._wakeup_fd, self._level_fd):
+            if fd is not None:
+                os.close(fd)
+        self._wakeup_fd = None
+        self._level_fd = None
+
 
 class BatteryManager(object):
     """
@@ -137,6 +222,8 @@ class BatteryManager(object):
             self._battery_thread.join(timeout=2)
             if self._battery_thread.is_alive():
                 self._logger.error("Could not stop BatteryNotify thread")
+            else:
+                self._battery_thread.close()
 
     def __del__(self):
         self.close()
@@ -151,6 +238,7 @@ class BatteryManager(object):
             self._battery_thread.event.set()
         else:
             self._battery_thread.event.clear()
+        self._battery_thread.wake()
 
     @property
     def frequency(self):
@@ -159,6 +247,7 @@ class BatteryManager(object):
     @frequency.setter
     def frequency(self, frequency):
         self._battery_thread.frequency = frequency
+        self._battery_thread.wake()
 
     @property
     def percent(self):
@@ -167,3 +256,4 @@ class BatteryManager(object):
     @percent.setter
     def percent(self, percent):
         self._battery_thread.percent = percent
+        self._battery_thread.wake()
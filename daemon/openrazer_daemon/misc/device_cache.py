@@ -0,0 +1,158 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+On disk cache of static device information
+
+Reading the serial of a device is a USB transfer, which adds up on every
+daemon start. The cache keeps it between runs and checks it against the
+USB descriptor of the device, which is read from sysfs without talking to
+the device.
+
+Devices behind a wireless receiver have the descriptor of the receiver, so
+they aren't cached. The firmware version isn't cached either, a firmware
+update doesn't have to change the descriptor.
+"""
+import json
+import logging
+import os
+import threading
+
+CACHE_VERSION = 2
+
+
+class DeviceCache(object):
+    """
+    Cache of the serial and other static info per device
+    """
+
+    def __init__(self, cache_file, daemon_version):
+        self._logger = logging.getLogger('razer.device_cache')
+        self._cache_file = cache_file
+        self._daemon_version = daemon_version
+        self._lock = threading.Lock()
+        self._entries = {}
+        self._changed = False
+
+        self._load()
+
+    def _load(self):
+        try:
+            with open(self._cache_file, 'r') as cache_file:
+                data = json.load(cache_file)
+        except FileNotFoundError:
+            return
+        except (OSError, ValueError) as err:
+            self._logger.warning("Failed to read device cache, ignoring it: %s", err)
+            return
+
+        # Method tables and the like may differ between versions
+        if data.get('version') != CACHE_VERSION or data.get('daemon_version') != self._daemon_version:
+            self._logger.debug("Device cache is from another version, ignoring it")
+            return
+
+        self._entries = data.get('devices', {})
+
+    @staticmethod
+    def usb_identity(device_path):
+        """
+        Get what identifies the USB device of a HID interface, read from sysfs only
+
+        :param device_path: Path of the HID interface
+        :type device_path: str
+
+        :return: Dict of port, vid, pid, bcd and USB serial or None if it's not a USB device
+        :rtype: dict or None
+        """
+        interface_path = os.path.dirname(os.path.realpath(device_path))
+        usb_path = os.path.dirname(interface_path)
+
+        identity = {'port': os.path.basename(interface_path)}
+        for key, attribute in (('vid', 'idVendor'), ('pid', 'idProduct'), ('bcd', 'bcdDevice'), ('usb_serial', 'serial')):
+            try:
+                with open(os.path.join(usb_path, attribute), 'r') as attribute_file:
+                    identity[key] = attribute_file.read().strip()
+            except OSError:
+                identity[key] = None
+
+        if identity['bcd'] is None:
+            return None
+
+        return identity
+
+    def lookup_serial(self, device_path, device_class):
+        """
+        Get the cached serial of a device without asking the device
+
+        Only devices with a serial in their USB descriptor can be told apart
+        this way, for others the serial has to be read from the device.
+
+        :param device_path: Path of the HID interface
+        :type device_path: str
+
+        :param device_class: Name of the device class
+        :type device_class: str
+
+        :return: Serial or None
+        :rtype: str or None
+        """
+        identity = self.usb_identity(device_path)
+        if identity is None or not identity['usb_serial']:
+            return None
+
+        with self._lock:
+            for serial, entry in self._entries.items():
+                if entry.get('identity') == identity and entry.get('class') == device_class:
+                    return serial
+
+        return None
+
+    def set(self, serial, device_path, device_class, key, value):
+        """
+        Store a value of a device
+
+        :param serial: Device serial
+        :type serial: str
+
+        :param device_path: Path of the HID interface
+        :type device_path: str
+
+        :param device_class: Name of the device class
+        :type device_class: str
+
+        :param key: Name of the value
+        :type key: str
+
+        :param value: Value, has to be JSON serialisable
+        """
+        identity = self.usb_identity(device_path)
+        if identity is None:
+            return
+
+        with self._lock:
+            entry = self._entries.get(serial)
+            if entry is None or entry.get('identity') != identity:
+                entry = self._entries[serial] = {'identity': identity, 'class': device_class}
+
+            if entry.get(key) != value:
+                entry[key] = value
+                self._changed = True
+
+    def save(self):
+        """
+        Write the cache to disk if it changed
+        """
+        with self._lock:
+            if not self._changed:
+                return
+
+            data = {'version': CACHE_VERSION, 'daemon_version': self._daemon_version, 'devices': self._entries}
+            tmp_file = self._cache_file + '.tmp'
+            try:
+                with open(tmp_file, 'w') as cache_file:
+                    json.dump(data, cache_file, indent=1)
+                os.replace(tmp_file, self._cache_file)
+            except OSError as err:
+                self._logger.warning("Failed to write device cache: %s", err)
+                return
+
+            self._changed = False
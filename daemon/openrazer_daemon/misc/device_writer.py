@@ -0,0 +1,97 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Per device thread doing driver writes off the main loop
+"""
+import collections
+import logging
+import threading
+
+
+class DeviceWriter(threading.Thread):
+    """
+    Thread to run queued driver writes of one device in order
+
+    Every write is queued under a key, queueing a write under a key that's
+    still pending replaces the pending write and moves it to the back of the
+    queue. That way a slow device only ever gets the newest frame.
+
+    Writes run with the write lock held. cancel() takes it too, so once it
+    returns no write queued before is running or will still run.
+    """
+
+    def __init__(self, device_id):
+        super().__init__(name='razer.device{0}.writer'.format(device_id), daemon=True)
+        self._logger = logging.getLogger('razer.device{0}.writer'.format(device_id))
+
+        self._cond = threading.Condition()
+        self._pending = collections.OrderedDict()
+        self._generation = 0
+        self._shutdown = False
+
+        self._write_lock = threading.Lock()
+
+    def submit(self, key, func, *args):
+        """
+        Queue a write
+
+        :param key: Key to coalesce writes on
+        :type key: tuple
+
+        :param func: Function doing the write
+        :type func: callable
+
+        :param args: Arguments for func
+        :type args: list
+        """
+        with self._cond:
+            self._pending[key] = (func, args)
+            self._pending.move_to_end(key)
+            self._cond.notify()
+
+    def cancel(self):
+        """
+        Drop all pending writes and wait for a running one to finish
+        """
+        with self._cond:
+            self._pending.clear()
+            self._generation += 1
+
+        with self._write_lock:
+            pass
+
+    def run(self):
+        while True:
+            with self._cond:
+                while not self._pending and not self._shutdown:
+                    self._cond.wait()
+
+                if self._shutdown:
+                    break
+
+                key, (func, args) = self._pending.popitem(last=False)
+                generation = self._generation
+
+            with self._write_lock:
+                with self._cond:
+                    # Cancelled between taking it off the queue and getting the lock
+                    if generation != self._generation or self._shutdown:
+                        continue
+
+                try:
+                    func(*args)
+                except OSError as err:
+                    self._logger.warning("Failed to run %s: %s", key[0], err)
+                except Exception:
+                    self._logger.exception("Failed to run %s", key[0])
+
+    def close(self):
+        """
+        Stop the thread, pending writes are dropped
+        """
+        with self._cond:
+            self._shutdown = True
+            self._cond.notify()
+
+        if self.is_alive() and threading.current_thread() is not self:
+            self.join()
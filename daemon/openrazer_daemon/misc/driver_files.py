@@ -0,0 +1,83 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Cache of open driver files so hot attributes aren't reopened on every write
+"""
+import errno
+import logging
+import os
+import threading
+
+# Errors after which the file is reopened, the device might have been
+# unbound and bound again in the meantime
+REOPEN_ERRNOS = (errno.ENODEV, errno.ENOENT, errno.EBADF, errno.ESTALE)
+
+
+class DriverFileCache(object):
+    """
+    Keeps one write-only file descriptor per driver file
+
+    :param truncate: Truncate the file after every write, for regular files standing in for sysfs attributes
+    :type truncate: bool
+    """
+
+    def __init__(self, truncate=False):
+        self._logger = logging.getLogger('razer.driver_files')
+        self._lock = threading.Lock()
+        self._files = {}
+        self._truncate = truncate
+
+    def _open(self, driver_path):
+        fd = os.open(driver_path, os.O_WRONLY | os.O_CLOEXEC)
+        self._files[driver_path] = fd
+        return fd
+
+    def _drop(self, driver_path):
+        fd = self._files.pop(driver_path, None)
+        if fd is not None:
+            try:
+                os.close(fd)
+            except OSError:
+                pass
+
+    def _write(self, fd, payload):
+        written = os.pwrite(fd, payload, 0)
+        if written != len(payload):
+            raise OSError(errno.EIO, "Short write to driver file, {0} of {1} bytes written".format(written, len(payload)))
+
+        if self._truncate:
+            os.ftruncate(fd, len(payload))
+
+    def write(self, driver_path, payload):
+        """
+        Write a payload to a driver file, opening it on first use
+
+        :param driver_path: Full path to the driver file
+        :type driver_path: str
+
+        :param payload: Data to write
+        :type payload: bytes
+        """
+        with self._lock:
+            try:
+                fd = self._files[driver_path]
+            except KeyError:
+                fd = self._open(driver_path)
+
+            try:
+                self._write(fd, payload)
+            except OSError as err:
+                if err.errno not in REOPEN_ERRNOS:
+                    raise
+
+                self._logger.debug("Reopening %s after %s", driver_path, os.strerror(err.errno))
+                self._drop(driver_path)
+                self._write(self._open(driver_path), payload)
+
+    def close(self):
+        """
+        Close all cached file descriptors
+        """
+        with self._lock:
+            for driver_path in list(self._files):
+                self._drop(driver_path)
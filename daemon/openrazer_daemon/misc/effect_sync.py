@@ -6,6 +6,27 @@ Class to manage syncing of effects
 import inspect
 import logging
 
+GREEN = (0x00, 0xFF, 0x00)
+
+ZONES = ('Scroll', 'Logo', 'Left', 'Right', 'Backlight')
+PULSATE_ZONES = ('Scroll', 'Logo', 'Backlight')
+
+
+def zone_methods(method_format, zones=ZONES):
+    """
+    Get the names of a method for each zone
+
+    :param method_format: Method name with {0} for the zone
+    :type method_format: str
+
+    :param zones: Zones
+    :type zones: tuple of str
+
+    :return: Method names
+    :rtype: tuple of str
+    """
+    return tuple(method_format.format(zone) for zone in zones)
+
 
 class EffectSync(object):
     """
@@ -17,6 +38,9 @@ class EffectSync(object):
         self._parent = parent
         self._parent.register_observer(self)
 
+        # (effect name, number of arguments) -> handlers, see _get_handlers
+        self._handlers = {}
+
     def __del__(self):
         self.close()
 
@@ -56,257 +80,8 @@ class EffectSync(object):
         self._parent.disable_notify = True
 
         try:
-            # Does parent have method
-            effect_func = getattr(self._parent, effect_name, None)
-            if effect_func is not None:
-                # We have method, does it have the correct num arguments
-                actual_args = self.get_num_arguments(effect_func)
-                if actual_args == len(args):
-                    # method should be same
-                    effect_func(*args)
-                else:
-                    # Method same but wrong args, try alternatives
-                    if effect_name == 'setStatic':
-                        # Could be static from chroma to non chroma
-                        if actual_args == 0:
-                            # Chroma -> BW
-                            effect_func()
-                        else:
-                            # BW -> Chroma
-                            effect_func(0x0, 0xFF, 0x00)  # Green
-
-            else:
-                # setNone sets active to false and needs to be re-enabled for effects to show - maybe a bit inefficient
-                if not effect_name == 'setNone':
-                    effect_func = getattr(self._parent, 'setScrollActive', None)
-                    if effect_func is not None:
-                        effect_func(True)
-                    effect_func = getattr(self._parent, 'setLogoActive', None)
-                    if effect_func is not None:
-                        effect_func(True)
-                    effect_func = getattr(self._parent, 'setLeftActive', None)
-                    if effect_func is not None:
-                        effect_func(True)
-                    effect_func = getattr(self._parent, 'setRightActive', None)
-                    if effect_func is not None:
-                        effect_func(True)
-                    effect_func = getattr(self._parent, 'setBacklightActive', None)
-                    if effect_func is not None:
-                        effect_func(True)
-                else:
-                    effect_func = getattr(self._parent, 'setScrollNone', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setLogoNone', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setLeftNone', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setRightNone', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setBacklightNone', None)
-                    if effect_func is not None:
-                        effect_func()
-
-                # The target device doesn't have these methods, use similar ones
-
-                if effect_name == 'setPulsate':
-                    # setPulsate doesn't provide a color but we need one, take green.
-                    pargs = (0x00, 0xFF, 0x00)  # Green
-                    effect_func = getattr(self._parent, 'setBreathSingle', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setScrollBreathSingle', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setLogoBreathSingle', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setLeftBreathSingle', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setRightBreathSingle', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setScrollPulsate', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setLogoPulsate', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-                    effect_func = getattr(self._parent, 'setBacklightPulsate', None)
-                    if effect_func is not None:
-                        effect_func(*pargs)
-
-                elif effect_name == 'setSpectrum':
-                    effect_func = getattr(self._parent, 'setScrollSpectrum', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setLogoSpectrum', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setLeftSpectrum', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setRightSpectrum', None)
-                    if effect_func is not None:
-                        effect_func()
-                    effect_func = getattr(self._parent, 'setBacklightSpectrum', None)
-                    if effect_func is not None:
-                        effect_func()
-
-                elif effect_name == 'setStatic':
-                    effect_func = getattr(self._parent, 'setScrollStatic', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLogoStatic', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLeftStatic', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setRightStatic', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setBacklightStatic', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-
-                elif effect_name == 'setWave':
-                    effect_func = getattr(self._parent, 'setScrollWave', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLogoWave', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLeftWave', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setRightWave', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setBacklightWave', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-
-                elif effect_name == 'setReactive':
-                    effect_func = getattr(self._parent, 'setScrollReactive', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLogoReactive', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLeftReactive', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setRightReactive', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setBacklightReactive', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-
-                elif effect_name in ('setBreathRandom', 'setBreathSingle', 'setBreathDual', 'setBreathTriple'):
-                    if effect_name in ('setBreathRandom', 'setBreathSingle'):
-                        pargs = (0x00, 0xFF, 0x00)  # Green
-                    else:
-                        pargs = args[0:3]  # limit args to first 3, as setBreathDual gives 6 args and setBreathTriple gives 9 args
-
-                    if effect_name == 'setBreathRandom':
-                        effect_func = getattr(self._parent, 'setPulsate', None)
-                        if effect_func is not None:
-                            # setPulsate doesn't take any argument
-                            effect_func()
-                        effect_func = getattr(self._parent, 'setScrollPulsate', None)
-                        if effect_func is not None:
-                            effect_func(*pargs)
-                        effect_func = getattr(self._parent, 'setLogoPulsate', None)
-                        if effect_func is not None:
-                            effect_func(*pargs)
-                        effect_func = getattr(self._parent, 'setBacklightPulsate', None)
-                        if effect_func is not None:
-                            effect_func(*pargs)
-
-                        effect_func = getattr(self._parent, 'setScrollBreathRandom', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setLogoBreathRandom', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setLeftBreathRandom', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setRightBreathRandom', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setBacklightBreathRandom', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-
-                    if effect_name == 'setBreathSingle':
-                        if effect_func is not None:
-                            effect_func(*pargs)
-                        effect_func = getattr(self._parent, 'setScrollPulsate', None)
-                        if effect_func is not None:
-                            effect_func(*pargs)
-                        effect_func = getattr(self._parent, 'setLogoPulsate', None)
-                        if effect_func is not None:
-                            effect_func(*pargs)
-                        effect_func = getattr(self._parent, 'setBacklightPulsate', None)
-                        if effect_func is not None:
-                            effect_func(*pargs)
-
-                        effect_func = getattr(self._parent, 'setScrollBreathSingle', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setLogoBreathSingle', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setLeftBreathSingle', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setRightBreathSingle', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setBacklightBreathSingle', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-
-                    if effect_name == 'setBreathDual':
-                        effect_func = getattr(self._parent, 'setScrollBreathDual', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setLogoBreathDual', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setLeftBreathDual', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setRightBreathDual', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-                        effect_func = getattr(self._parent, 'setBacklightBreathDual', None)
-                        if effect_func is not None:
-                            effect_func(*args)
-
-                elif effect_name == 'setBrightness':
-                    effect_func = getattr(self._parent, 'setScrollBrightness', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLogoBrightness', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setLeftBrightness', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setRightBrightness', None)
-                    if effect_func is not None:
-                        effect_func(*args)
-                    effect_func = getattr(self._parent, 'setBacklightBrightness', None)
-                    if effect_func is not None:
-                        effect_func(*args)
+            for effect_func, effect_args in self._get_handlers(effect_name, len(args)):
+                effect_func(*(args if effect_args is None else effect_args))
 
         except Exception as err:
             self._logger.exception("Caught exception trying to sync effects.", exc_info=err)
@@ -314,6 +89,97 @@ class EffectSync(object):
         # Re-enable notifications
         self._parent.disable_notify = False
 
+    def _get_handlers(self, effect_name, num_args):
+        """
+        Get the methods of the device that apply an effect, resolved on first use
+
+        :param effect_name: Name of the effect
+        :type effect_name: str
+
+        :param num_args: Number of arguments the effect was sent with
+        :type num_args: int
+
+        :return: Tuple of (method, arguments or None to pass the effect's arguments)
+        :rtype: tuple
+        """
+        key = (effect_name, num_args)
+        handlers = self._handlers.get(key)
+        if handlers is None:
+            handlers = self._handlers[key] = tuple(self._resolve_handlers(effect_name, num_args))
+
+        return handlers
+
+    def _resolve_handlers(self, effect_name, num_args):
+        """
+        Work out which methods of the device apply an effect from another device
+
+        :param effect_name: Name of the effect
+        :type effect_name: str
+
+        :param num_args: Number of arguments the effect was sent with
+        :type num_args: int
+
+        :return: List of (method, arguments or None to pass the effect's arguments)
+        :rtype: list
+        """
+        # Does parent have method
+        effect_func = getattr(self._parent, effect_name, None)
+        if effect_func is not None:
+            # We have method, does it have the correct num arguments
+            actual_args = self.get_num_arguments(effect_func)
+            if actual_args == num_args:
+                # method should be same
+                return [(effect_func, None)]
+
+            # Method same but wrong args, try alternatives
+            if effect_name == 'setStatic':
+                # Could be static from chroma to non chroma
+                if actual_args == 0:
+                    # Chroma -> BW
+                    return [(effect_func, ())]
+                # BW -> Chroma
+                return [(effect_func, GREEN)]
+
+            return []
+
+        handlers = []
+
+        def add(method_names, effect_args):
+            for method_name in method_names:
+                zone_func = getattr(self._parent, method_name, None)
+                if zone_func is not None:
+                    handlers.append((zone_func, effect_args))
+
+        # setNone sets active to false and needs to be re-enabled for effects to show - maybe a bit inefficient
+        if not effect_name == 'setNone':
+            add(zone_methods('set{0}Active'), (True,))
+        else:
+            add(zone_methods('set{0}None'), ())
+
+        # The target device doesn't have these methods, use similar ones
+
+        if effect_name == 'setPulsate':
+            # setPulsate doesn't provide a color but we need one, take green.
+            add(('setBreathSingle',) + zone_methods('set{0}BreathSingle', ZONES[:4]), GREEN)
+            add(zone_methods('set{0}Pulsate', PULSATE_ZONES), GREEN)
+
+        elif effect_name == 'setSpectrum':
+            add(zone_methods('set{0}Spectrum'), ())
+
+        elif effect_name in ('setStatic', 'setWave', 'setReactive', 'setBrightness'):
+            add(zone_methods('set{0}' + effect_name[3:]), None)
+
+        elif effect_name in ('setBreathRandom', 'setBreathSingle'):
+            # setPulsate doesn't take any argument
+            add(('setPulsate',), ())
+            add(zone_methods('set{0}Pulsate', PULSATE_ZONES), GREEN)
+            add(zone_methods('set{0}' + effect_name[3:]), None)
+
+        elif effect_name == 'setBreathDual':
+            add(zone_methods('set{0}BreathDual'), None)
+
+        return handlers
+
     @staticmethod
     def get_num_arguments(func):
         """
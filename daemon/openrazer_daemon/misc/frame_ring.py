@@ -0,0 +1,100 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Shared memory ring of custom frames written by a client and applied by the daemon
+"""
+import logging
+import mmap
+import os
+import struct
+import threading
+
+# Header: sequence number of the newest frame, number of slots, size of a
+# frame in bytes, closed flag. Frames follow the header, frame N lives in
+# slot N % slots and is a complete setKeyRow payload.
+HEADER = struct.Struct('<IIII')
+SEQ_OFFSET = 0
+CLOSED_OFFSET = 12
+
+DEFAULT_SLOTS = 4
+
+
+class FrameRing(threading.Thread):
+    """
+    Thread to apply the newest frame of the ring whenever the client rings the eventfd
+
+    Frames the client published while the previous one was being written are
+    skipped, only the newest one is applied.
+    """
+
+    def __init__(self, parent, device_id, frame_size, slots=DEFAULT_SLOTS):
+        super().__init__(name='razer.device{0}.framering'.format(device_id), daemon=True)
+        self._logger = logging.getLogger('razer.device{0}.framering'.format(device_id))
+        self._parent = parent
+
+        self._frame_size = frame_size
+        self._slots = slots
+        self._shutdown = False
+
+        self.memfd = os.memfd_create('razer-frame-ring', os.MFD_CLOEXEC)
+        os.ftruncate(self.memfd, HEADER.size + slots * frame_size)
+        self._mmap = mmap.mmap(self.memfd, HEADER.size + slots * frame_size)
+        HEADER.pack_into(self._mmap, 0, 0, slots, frame_size, 0)
+
+        self.eventfd = os.eventfd(0, os.EFD_CLOEXEC)
+
+    def _seq(self):
+        return struct.unpack_from('<I', self._mmap, SEQ_OFFSET)[0]
+
+    def _read_newest(self):
+        """
+        Copy the newest frame out of the ring
+
+        The client may lap us while we copy, in which case the copy is retried.
+        """
+        while True:
+            seq = self._seq()
+            start = HEADER.size + (seq % self._slots) * self._frame_size
+            frame = self._mmap[start:start + self._frame_size]
+
+            if (self._seq() - seq) & 0xFFFFFFFF < self._slots - 1:
+                return seq, frame
+
+    def run(self):
+        self._logger.debug("Frame ring opened")
+        last_seq = self._seq()
+
+        while not self._shutdown:
+            try:
+                os.eventfd_read(self.eventfd)
+            except OSError:
+                break
+
+            if self._shutdown:
+                break
+
+            seq, frame = self._read_newest()
+            if seq == last_seq:
+                continue
+            last_seq = seq
+
+            # Same path as setKeyRow, a frame still pending on the writer is replaced by this one
+            self._parent.queue_write(self._parent._key_row_key(frame), self._parent._set_key_row, frame)
+            self._parent.queue_write(('set_custom_effect',), self._parent._set_custom_effect)
+
+        self._logger.debug("Frame ring closed")
+
+    def close(self):
+        """
+        Mark the ring as closed for the client and stop the thread
+        """
+        self._shutdown = True
+        struct.pack_into('<I', self._mmap, CLOSED_OFFSET, 1)
+        os.eventfd_write(self.eventfd, 1)
+
+        if self.is_alive() and threading.current_thread() is not self:
+            self.join()
+
+        self._mmap.close()
+        os.close(self.memfd)
+        os.close(self.eventfd)
@@ -0,0 +1,131 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Frame pacing for effects the daemon renders itself
+"""
+import collections
+import time
+
+# How often the achieved frame rate is logged, in seconds
+STATS_INTERVAL = 30
+
+# Number of frame times kept for the percentiles
+FRAME_TIME_HISTORY = 512
+
+
+class FrameScheduler(object):
+    """
+    Sleeps until absolute frame deadlines so render and write time don't add up to drift
+
+    When a frame takes longer than the interval, the frames that were missed
+    are skipped instead of being rendered back to back.
+    """
+
+    def __init__(self, logger, interval):
+        self._logger = logger
+        self._interval = interval
+
+        self._frame_times = collections.deque(maxlen=FRAME_TIME_HISTORY)
+        self.reset()
+
+    @property
+    def interval(self):
+        """
+        Get the frame interval
+
+        :return: Interval in seconds
+        :rtype: float
+        """
+        return self._interval
+
+    @interval.setter
+    def interval(self, value):
+        """
+        Set the frame interval, takes effect from the next frame
+
+        :param value: Interval in seconds
+        :type value: float
+        """
+        if value != self._interval:
+            self._interval = value
+            self.reset()
+
+    def reset(self):
+        """
+        Forget the schedule, the next wait starts a new one
+
+        Used when the effect stops, so an idle pause doesn't count as missed frames.
+        """
+        self._deadline = None
+        self._frame_start = None
+
+        self._stats_start = None
+        self._stats_frames = 0
+        self._stats_skipped = 0
+        self._frame_times.clear()
+
+    def wait(self):
+        """
+        Finish the current frame and sleep until the next one is due
+        """
+        now = time.monotonic()
+
+        if self._deadline is None:
+            self._deadline = now
+            self._stats_start = now
+        else:
+            self._frame_times.append(now - self._frame_start)
+            self._stats_frames += 1
+
+        self._deadline += self._interval
+
+        # Behind schedule, skip the frames we missed
+        if now > self._deadline:
+            missed = int((now - self._deadline) // self._interval) + 1
+            self._stats_skipped += missed
+            self._deadline += missed * self._interval
+
+        time.sleep(self._deadline - now)
+        self._frame_start = time.monotonic()
+
+        if self._frame_start - self._stats_start >= STATS_INTERVAL:
+            self._log_stats()
+
+    def stats(self):
+        """
+        Get the achieved frame rate and frame times since the last report
+
+        :return: Dict of fps, skipped frames and 50th, 95th and 99th percentile frame times in ms
+        :rtype: dict
+        """
+        elapsed = time.monotonic() - self._stats_start if self._stats_start is not None else 0
+        frame_times = sorted(self._frame_times)
+
+        result = {
+            'fps': self._stats_frames / elapsed if elapsed > 0 else 0.0,
+            'skipped': self._stats_skipped,
+        }
+        for percentile in (50, 95, 99):
+            if frame_times:
+                index = min(len(frame_times) - 1, len(frame_times) * percentile // 100)
+                result['p{0}'.format(percentile)] = frame_times[index] * 1000
+            else:
+                result['p{0}'.format(percentile)] = 0.0
+
+        return result
+
+    def _log_stats(self):
+        stats = self.stats()
+        target_fps = 1 / self._interval
+
+        message = "%.1f/%.1f fps, %d frames skipped, frame time p50 %.1f ms p95 %.1f ms p99 %.1f ms"
+        args = (stats['fps'], target_fps, stats['skipped'], stats['p50'], stats['p95'], stats['p99'])
+        if stats['skipped'] > 0:
+            self._logger.warning("Can't keep up: " + message, *args)
+        else:
+            self._logger.debug(message, *args)
+
+        self._stats_start = self._frame_start
+        self._stats_frames = 0
+        self._stats_skipped = 0
+        self._frame_times.clear()
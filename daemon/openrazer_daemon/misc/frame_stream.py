@@ -0,0 +1,71 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Stream custom frames from a client over a socket instead of one DBus call per frame
+"""
+import logging
+import socket
+import threading
+
+# Largest frame we accept, the biggest matrix is well below this
+MAX_FRAME_SIZE = 64 * 1024
+
+
+class FrameStream(threading.Thread):
+    """
+    Thread to read frames from a client socket and apply them to the device
+
+    Every message on the socket is one setKeyRow payload, the device is switched
+    to the custom effect after each frame.
+    """
+
+    def __init__(self, parent, device_id):
+        super().__init__(name='razer.device{0}.framestream'.format(device_id), daemon=True)
+        self._logger = logging.getLogger('razer.device{0}.framestream'.format(device_id))
+        self._parent = parent
+
+        self._socket, self._client_socket = socket.socketpair(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+        self._shutdown = False
+
+    def take_client_fd(self):
+        """
+        Get the client end of the socket, ownership moves to the caller
+
+        :return: File descriptor
+        :rtype: int
+        """
+        return self._client_socket.detach()
+
+    def run(self):
+        self._logger.debug("Frame stream opened")
+
+        while not self._shutdown:
+            try:
+                frame = self._socket.recv(MAX_FRAME_SIZE)
+            except OSError:
+                break
+
+            # Client closed its end
+            if not frame:
+                break
+
+            # Same path as setKeyRow, a frame still pending on the writer is replaced by this one
+            self._parent.queue_write(self._parent._key_row_key(frame), self._parent._set_key_row, frame)
+            self._parent.queue_write(('set_custom_effect',), self._parent._set_custom_effect)
+
+        self._socket.close()
+        self._logger.debug("Frame stream closed")
+
+    def close(self):
+        """
+        Stop reading frames and wait for the thread to finish
+        """
+        self._shutdown = True
+        try:
+            self._socket.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        self._client_socket.close()
+
+        if self.is_alive() and threading.current_thread() is not self:
+            self.join()
@@ -14,7 +14,7 @@ Each event is in the format of
 * unsigned short code
 * signed int value
 """
-import datetime
+import collections
 import fcntl
 import json
 import logging
@@ -27,15 +27,23 @@ import time
 
 # pylint: disable=import-error
 from openrazer_daemon.keyboard import KEY_MAPPING, TARTARUS_KEY_MAPPING, EVENT_MAPPING, TARTARUS_EVENT_MAPPING, NAGA_HEX_V2_EVENT_MAPPING, NAGA_HEX_V2_KEY_MAPPING, ORBWEAVER_EVENT_MAPPING, ORBWEAVER_KEY_MAPPING
-from .macro import MacroKey, MacroRunner, macro_dict_to_obj
+from .macro import MacroKey, MacroRunner, UinputKeyboard, macro_dict_to_obj
 
 EVENT_FORMAT = '@llHHI'
 EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
 
-EPOLL_TIMEOUT = 0.01
-SPIN_SLEEP = 0.01
+# Number of events read at once
+READ_BATCH = 64
+
+# Most keys kept for the ripple effect, older ones are dropped when typing faster than this in the expiry time
+KEY_HISTORY_SIZE = 256
 
 EVIOCGRAB = 0x40044590
+EVIOCSCLOCKID = 0x400445a0
+CLOCK_MONOTONIC = 1
+
+# How long a key press stays in the history for the ripple effect, in ns
+KEY_EXPIRE_TIME = 2 * 1000000000
 
 COLOUR_CHOICES = (
     (255, 0, 0),    # Red
@@ -66,9 +74,76 @@ def random_colour_picker(last_choice, iterable):
     return result
 
 
+class KeyHistory(object):
+    """
+    Time ordered history of recent key presses
+
+    Only the KeyWatcher thread adds and expires keys. Readers don't lock, they
+    copy the keys only when the sequence number moved since their last copy
+    and cut expired keys off the front of it.
+    """
+
+    def __init__(self, size=KEY_HISTORY_SIZE):
+        self._keys = collections.deque(maxlen=size)
+        self._seq = 0
+
+        self._snapshot_seq = -1
+        self._snapshot = ()
+
+    def append(self, key):
+        """
+        Add a key
+
+        :param key: Tuple of expire time, key position and colour
+        :type key: tuple
+        """
+        self._keys.append(key)
+        self._seq += 1
+
+    def expire(self, now):
+        """
+        Drop expired keys
+
+        :param now: Current monotonic time in ns
+        :type now: int
+        """
+        keys = self._keys
+        while keys and keys[0][0] < now:
+            keys.popleft()
+
+    def snapshot(self, now):
+        """
+        Get the keys that haven't expired
+
+        :param now: Current monotonic time in ns
+        :type now: int
+
+        :return: Tuple of keys, oldest first
+        :rtype: tuple
+        """
+        seq = self._seq
+        if seq != self._snapshot_seq:
+            # Copying a deque happens under the GIL, appends can't interleave
+            self._snapshot = tuple(self._keys)
+            self._snapshot_seq = seq
+
+        snapshot = self._snapshot
+        start = 0
+        while start < len(snapshot) and snapshot[start][0] < now:
+            start += 1
+
+        if start > 0:
+            snapshot = self._snapshot = snapshot[start:]
+
+        return snapshot
+
+
 class KeyWatcher(threading.Thread):
     """
     Thread to watch keyboard event files and return keypresses
+
+    Blocks in epoll until there are events or the thread is told to stop
+    through an eventfd, so an idle keyboard costs no wakeups.
     """
     @staticmethod
     def parse_event_record(data):
@@ -78,12 +153,14 @@ class KeyWatcher(threading.Thread):
         :param data: Binary data
         :type data: bytes
 
-        :return: Tuple of event time, key_action, key_code
+        :return: Tuple of event time in ns, key_action, key_code
         :rtype: tuple
         """
-        # Event Seconds, Event Microseconds, Event Type, Event Code, Event Value
-        ev_sec, ev_usec, ev_type, ev_code, ev_value = struct.unpack(EVENT_FORMAT, data)
+        return KeyWatcher._parse_event(*struct.unpack(EVENT_FORMAT, data))
 
+    @staticmethod
+    def _parse_event(ev_sec, ev_usec, ev_type, ev_code, ev_value):
+        # Event Seconds, Event Microseconds, Event Type, Event Code, Event Value
         if ev_type != 0x01:  # input-event-codes.h EV_KEY 0x01
             return None, None, None
 
@@ -96,102 +173,106 @@ class KeyWatcher(threading.Thread):
         else:
             key_action = 'unknown'
 
-        seconds = ev_sec + (ev_usec * 0.000001)
-        date = datetime.datetime.fromtimestamp(seconds)
+        event_time = ev_sec * 1000000000 + ev_usec * 1000
 
-        result = (date, key_action, ev_code)
+        result = (event_time, key_action, ev_code)
 
         if ev_type == ev_code == ev_value == 0:
             return None, None, None
 
         return result
 
-    def __init__(self, device_id, event_files, parent, use_epoll=True):
+    def __init__(self, device_id, event_files, parent):
         super().__init__()
 
         self._logger = logging.getLogger('razer.device{0}.keywatcher'.format(device_id))
         self._event_files = event_files
         self._shutdown = False
-        self._use_epoll = use_epoll
         self._parent = parent
 
-        self.open_event_files = [open(event_file, 'rb') for event_file in self._event_files]
+        self.open_event_files = [open(event_file, 'rb', buffering=0) for event_file in self._event_files]
         # Set open files to non blocking mode
         for event_file in self.open_event_files:
             flags = fcntl.fcntl(event_file.fileno(), fcntl.F_GETFL)
             fcntl.fcntl(event_file.fileno(), fcntl.F_SETFL, flags | os.O_NONBLOCK)
 
+            # Get event times from the monotonic clock, fake event files in tests can't do that
+            try:
+                fcntl.ioctl(event_file.fileno(), EVIOCSCLOCKID, struct.pack('@i', CLOCK_MONOTONIC))
+            except OSError:
+                pass
+
+        # Written to on shutdown to wake the thread up, closed by close() once the thread is gone
+        self._shutdown_fd = os.eventfd(0, os.EFD_CLOEXEC | os.EFD_NONBLOCK)
+
     def run(self):
         """
         Main event loop
         """
-        # Create dict of Event File Descriptor: Event File Object
-        event_file_map = {event_file.fileno(): event_file for event_file in self.open_event_files}
+        event_fds = {event_file.fileno() for event_file in self.open_event_files}
 
         # Create epoll object
         poll_object = select.epoll()
 
         # Register files with select
-        for event_fd in event_file_map.keys():
+        for event_fd in event_fds:
             poll_object.register(event_fd, select.EPOLLIN | select.EPOLLPRI)
+        poll_object.register(self._shutdown_fd, select.EPOLLIN)
 
         # Loop
         while not self._shutdown:
-            # epoll is nice but it wasn't getting events properly :(
+            try:
+                events = poll_object.poll()
+            except InterruptedError:
+                continue
 
-            try:  # Cheap hack until i merged new code
-                if self._use_epoll:
-                    self._poll_epoll(poll_object, event_file_map)
-                else:
-                    self._poll_read()
-            except (IOError, OSError):  # Basically if there's an error, most likely device has been removed then it'll get deleted properly
-                pass
+            for event_fd, mask in events:
+                if event_fd == self._shutdown_fd:
+                    continue
 
-            time.sleep(SPIN_SLEEP)
+                try:
+                    self._read_events(event_fd)
+                except OSError:  # Basically if there's an error, most likely device has been removed then it'll get deleted properly
+                    mask |= select.EPOLLERR
+
+                # Stop watching a removed device, epoll would report it forever
+                if mask & (select.EPOLLERR | select.EPOLLHUP) and event_fd in event_fds:
+                    poll_object.unregister(event_fd)
+                    event_fds.discard(event_fd)
 
         # Unbind files and close them
-        for event_fd, event_file in event_file_map.items():
+        for event_fd in event_fds:
             poll_object.unregister(event_fd)
+        for event_file in self.open_event_files:
             event_file.close()
 
         poll_object.close()
 
-    def _poll_epoll(self, poll_object, event_file_map):
-        events = poll_object.poll(EPOLL_TIMEOUT)
-
-        if len(events) != 0:
-            # pylint: disable=unused-variable
-            for event_fd, mask in events:
-                while True:
-                    key_data = event_file_map[event_fd].read(EVENT_SIZE)
-                    if not key_data:
-                        break
-
-                    date, key_action, key_code = self.parse_event_record(key_data)
-
-                    # Skip if date, key_action and key_code is none as that's a spacer record
-                    if date is None:
-                        continue
-
-                    # Now if key is pressed then we record
-                    self._parent.key_action(date, key_code, key_action)
-
-    def _poll_read(self):
-        for event_file in self.open_event_files:
+    def _read_events(self, event_fd):
+        """
+        Read all pending events of a file, many records per read
+        """
+        while True:
+            try:
+                key_data = os.read(event_fd, EVENT_SIZE * READ_BATCH)
+            except BlockingIOError:
+                return
 
-            key_data = event_file.read(EVENT_SIZE)
+            if not key_data:
+                return
 
-            if key_data is None:
-                continue
+            for record in struct.iter_unpack(EVENT_FORMAT, key_data[:len(key_data) - len(key_data) % EVENT_SIZE]):
+                event_time, key_action, key_code = self._parse_event(*record)
 
-            date, key_action, key_code = self.parse_event_record(key_data)
+                # Skip if event_time, key_action and key_code is none as that's a spacer record
+                if event_time is None:
+                    continue
 
-            # Skip if date, key_action and key_code is none as that's a spacer record
-            if date is None:
-                continue
+                # Now if key is pressed then we record
+                self._parent.key_action(event_time, key_code, key_action)
 
-            # Now if key is pressed then we record
-            self._parent.key_action(date, key_code, key_action)
+            if len(key_data) < EVENT_SIZE * READ_BATCH:
+                return
 
     @property
     def shutdown(self):
@@ -212,6 +293,24 @@ class KeyWatcher(threading.Thread):
         :type value: str
         """
         self._shutdown = value
+        if value and self._shutdown_fd is not None:
+            os.eventfd_write(self._shutdown_fd, 1)
+
+    def close(self):
+        """
+        Stop the thread and close the eventfd once it's gone
+        """
+        self.shutdown = True
+
+        if self.is_alive():
+            self.join(timeout=2)
+            if self.is_alive():
+                self._logger.error("Could not stop KeyWatcher thread")
+                return
+
+        if self._shutdown_fd is not None:
+            os.close(self._shutdown_fd)
+            self._shutdown_fd = None
 
 
 class KeyboardKeyManager(object):
@@ -229,6 +328,9 @@ class KeyboardKeyManager(object):
     KEY_MAP = KEY_MAPPING
     EVENT_MAP = EVENT_MAPPING
 
+    # Keys whose autorepeat counts as presses, defined in keyboard.py and razerkbd_driver.c
+    AUTOREPEAT_KEYS = frozenset((0x2ab, 0x2aa))
+
     # pylint: disable=too-many-instance-attributes
     def __init__(self, device_id, event_files, parent, use_epoll=False, testing=False, should_grab_event_files=False):
 
@@ -240,7 +342,8 @@ class KeyboardKeyManager(object):
 
         self._event_files = event_files
         self._access_lock = threading.Lock()
-        self._keywatcher = KeyWatcher(device_id, event_files, self, use_epoll=use_epoll)
+        # use_epoll is kept for the device classes, the KeyWatcher always uses epoll
+        self._keywatcher = KeyWatcher(device_id, event_files, self)
         self._open_event_files = self._keywatcher.open_event_files
 
         if len(event_files) > 0:
@@ -249,51 +352,65 @@ class KeyboardKeyManager(object):
         else:
             self._logger.warning("No event files for KeyWatcher")
 
+        # Create the macro keyboard now, one created right before a macro is
+        # typed on it loses the first keys while the system picks it up
+        if not testing:
+            UinputKeyboard.get()
+
         self._recording_macro = False
         self._macros = {}
 
         self._current_macro_bind_key = None
         self._current_macro_combo = []
 
-        self._threads = set()
-        self._clean_counter = 0
-
         self._temp_key_store_active = False
-        self._temp_key_store = []
-        self._temp_expire_time = datetime.timedelta(seconds=2)
+        self._temp_key_store = KeyHistory()
+        self._temp_expire_time = KEY_EXPIRE_TIME
 
         self._last_colour_choice = None
 
         self._should_grab_event_files = should_grab_event_files
         self._event_files_locked = False
 
+        # (key name, modifier state) -> handler, see _update_key_actions
+        self._key_actions = {}
+        self._update_key_actions()
+
         if self._should_grab_event_files:
             self.grab_event_files(True)
 
+    def _update_key_actions(self):
+        """
+        Rebuild the key dispatch table
+
+        The modifier state is whether a macro is being recorded. Keys without
+        an entry are ignored when not recording and recorded when recording,
+        so most key presses only cost a dict lookup. Has to be called
+        whenever the macros change.
+        """
+        key_actions = {}
+
+        for key_name in self._macros:
+            key_actions[(key_name, False)] = self._play_macro_key
+
+        # Special keys win over macros bound to them
+        for recording in (False, True):
+            key_actions[('MACROMODE', recording)] = self._macro_mode_key
+            key_actions[('GAMEMODE', recording)] = self._game_mode_key
+            key_actions[('BRIGHTNESSDOWN', recording)] = self._brightness_down_key
+            key_actions[('BRIGHTNESSUP', recording)] = self._brightness_up_key
+
+        self._key_actions = key_actions
+
     @property
     def temp_key_store(self):
         """
         Get the temporary key store
 
-        :return: List of keys
-        :rtype: list
+        :return: Tuple of keys
+        :rtype: tuple
         """
-        # Locking so it doesn't mutate whilst copying
-        self._access_lock.acquire()
-        now = datetime.datetime.now()
-
-        # Remove expired keys from store
-        try:
-            # Get date and if its less than now its expired
-            while self._temp_key_store[0][0] < now:
-                self._temp_key_store.pop(0)
-        except IndexError:
-            pass
-
-        # Creating a copy as then it doesn't mutate whilst iterating
-        result = self._temp_key_store[:]
-        self._access_lock.release()
-        return result
+        return self._temp_key_store.snapshot(time.monotonic_ns())
 
     @property
     def temp_key_store_state(self):
@@ -338,52 +455,35 @@ class KeyboardKeyManager(object):
           then it will record keys, then pressing FN+F9 will save macro.
         * Pressing any macro key will run macro.
         * Pressing FN+F10 will toggle game mode.
-        :param event_time: Time event occurred
-        :type event_time: datetime.datetime
+        :param event_time: Time event occurred in ns
+        :type event_time: int
 
         :param key_id: Key Event ID
         :type key_id: int
 
         :param key_press: Can either be press, release, autorepeat
-        :type key_press: bool
+        :type key_press: str
         """
-        # Disable pylints complaining for this part, #PerformanceOverNeatness
-        # pylint: disable=too-many-branches,too-many-statements
-
         # Get event files if they arnt locked #nasty hack
         if not self._event_files_locked and self._should_grab_event_files:
             self.grab_event_files(True)
 
         if key_press == 'autorepeat':  # TODO not done right yet
             # If its brightness then convert autorepeat to key presses
-            # Brightness keys are defined in keyboard.py and razerkbd_driver.c
-            if key_id in (0x2ab, 0x2aa):
-                key_press = 'press'
-            else:
+            if key_id not in self.AUTOREPEAT_KEYS:
                 # Quit out early
                 return
+            key_press = 'press'
 
-        now = datetime.datetime.now()
+        now = time.monotonic_ns()
 
         # Remove expired keys from store
-        try:
-            # Get date and if its less than now its expired
-            while self._temp_key_store[0][0] < now:
-                self._temp_key_store.pop(0)
-        except IndexError:
-            pass
-
-        # Clean up any threads
-        if self._clean_counter > 20 and len(self._threads) > 0:
-            self._clean_counter = 0
-            self.clean_macro_threads()
+        self._temp_key_store.expire(now)
 
         try:
             # Convert event ID to key name
             key_name = self.EVENT_MAP[key_id]
 
-            # self._logger.info("Got key: {0}, state: {1}".format(key_name, 'DOWN' if key_press else 'UP'))
-
             # Key release
             if key_press == 'release':
                 if self._recording_macro:
@@ -391,103 +491,107 @@ class KeyboardKeyManager(object):
                     if key_name not in (self._current_macro_bind_key, 'MACROMODE'):
                         # Record key release events
                         self._current_macro_combo.append((event_time, key_name, 'UP'))
+                return
 
+            # Key press
+            if self._temp_key_store_active:
+                colour = random_colour_picker(self._last_colour_choice, COLOUR_CHOICES)
+                self._last_colour_choice = colour
+                self._temp_key_store.append((now + self._temp_expire_time, self.KEY_MAP[key_name], colour))
+
+            if self._recording_macro:
+                handler = self._key_actions.get((key_name, True), self._record_macro_key)
             else:
-                # Key press
-
-                if self._temp_key_store_active:
-                    colour = random_colour_picker(self._last_colour_choice, COLOUR_CHOICES)
-                    self._last_colour_choice = colour
-                    self._temp_key_store.append((now + self._temp_expire_time, self.KEY_MAP[key_name], colour))
-
-                # Macro FN+F9 logic
-                if key_name == 'MACROMODE':
-                    self._logger.info("Got macro combo")
-
-                    if not self._recording_macro:
-                        # Starting to record macro
-                        self._recording_macro = True
-                        self._current_macro_bind_key = None
-                        self._current_macro_combo = []
-
-                        self._parent.setMacroEffect(0x01)
-                        self._parent.setMacroMode(True)
-
-                    else:
-                        self._logger.debug("Finished recording macro")
-                        # Finish recording macro
-                        if self._current_macro_bind_key is not None:
-                            if len(self._current_macro_combo) > 0:
-                                self.add_kb_macro()
-                            else:
-                                # Clear macro
-                                self.dbus_delete_macro(self._current_macro_bind_key)
-                        self._recording_macro = False
-                        self._parent.setMacroEffect(0x00)
-                        self._parent.setMacroMode(False)
-                # Sets up game mode as when enabling macro keys it stops the key working
-                elif key_name == 'GAMEMODE':
-                    self._logger.info("Got game mode combo")
-
-                    game_mode = self._parent.getGameMode()
-                    self._parent.setGameMode(not game_mode)
-
-                # Brightness logic
-                elif key_name == 'BRIGHTNESSDOWN':
-                    # Get brightness value
-                    current_brightness = self._parent.method_args.get('brightness', None)
-                    if current_brightness is None:
-                        current_brightness = self._parent.getBrightness()
-
-                    if current_brightness > 0:
-                        current_brightness -= 10
-                        if current_brightness < 0:
-                            current_brightness = 0
-
-                        self._parent.setBrightness(current_brightness)
-                        # self._parent.method_args['brightness'] = current_brightness
-                elif key_name == 'BRIGHTNESSUP':
-                    # Get brightness value
-                    current_brightness = self._parent.method_args.get('brightness', None)
-                    if current_brightness is None:
-                        current_brightness = self._parent.getBrightness()
-
-                    if current_brightness < 100:
-                        current_brightness += 10
-                        if current_brightness > 100:
-                            current_brightness = 100
-
-                        self._parent.setBrightness(current_brightness)
-                        # self._parent.method_args['brightness'] = current_brightness
-
-                elif self._recording_macro:
-
-                    if self._current_macro_bind_key is None:
-                        # Restrict macro bind keys to M1-M5
-                        if key_name not in ('M1', 'M2', 'M3', 'M4', 'M5', 'M6'):
-                            self._logger.warning("Macros are only for M1-M6 for now.")
-                            self._recording_macro = False
-                            self._parent.setMacroMode(False)
-                        else:
-                            self._current_macro_bind_key = key_name
-                            self._parent.setMacroEffect(0x00)
-                    # Don't want no recursion, cancel macro, don't let one call macro in a macro
-                    elif key_name == self._current_macro_bind_key:
-                        self._logger.warning("Skipping macro assignment as would cause recursion")
-                        self._recording_macro = False
-                        self._parent.setMacroMode(False)
-                    # Anything else just record it
-                    else:
-                        self._current_macro_combo.append((event_time, key_name, 'DOWN'))
-                # Not recording anything so if a macro key is pressed then run
-                else:
-                    # If key has a macro, play it
-                    if key_name in self._macros:
-                        self.play_macro(key_name)
+                handler = self._key_actions.get((key_name, False))
+                if handler is None:
+                    return
+
+            handler(event_time, key_name)
 
         except KeyError as err:
             self._logger.exception("Got key error. Couldn't convert event to key name", exc_info=err)
 
+    def _macro_mode_key(self, event_time, key_name):
+        """
+        Macro FN+F9 logic, starts or finishes recording a macro
+        """
+        self._logger.info("Got macro combo")
+
+        if not self._recording_macro:
+            # Starting to record macro
+            self._recording_macro = True
+            self._current_macro_bind_key = None
+            self._current_macro_combo = []
+
+            self._parent.setMacroEffect(0x01)
+            self._parent.setMacroMode(True)
+
+        else:
+            self._logger.debug("Finished recording macro")
+            # Finish recording macro
+            if self._current_macro_bind_key is not None:
+                if len(self._current_macro_combo) > 0:
+                    self.add_kb_macro()
+                else:
+                    # Clear macro
+                    self.dbus_delete_macro(self._current_macro_bind_key)
+            self._recording_macro = False
+            self._parent.setMacroEffect(0x00)
+            self._parent.setMacroMode(False)
+
+    def _game_mode_key(self, event_time, key_name):
+        """
+        Sets up game mode as when enabling macro keys it stops the key working
+        """
+        self._logger.info("Got game mode combo")
+
+        game_mode = self._parent.getGameMode()
+        self._parent.setGameMode(not game_mode)
+
+    def _get_brightness(self):
+        current_brightness = self._parent.method_args.get('brightness', None)
+        if current_brightness is None:
+            current_brightness = self._parent.getBrightness()
+
+        return current_brightness
+
+    def _brightness_down_key(self, event_time, key_name):
+        current_brightness = self._get_brightness()
+
+        if current_brightness > 0:
+            self._parent.setBrightness(max(current_brightness - 10, 0))
+
+    def _brightness_up_key(self, event_time, key_name):
+        current_brightness = self._get_brightness()
+
+        if current_brightness < 100:
+            self._parent.setBrightness(min(current_brightness + 10, 100))
+
+    def _record_macro_key(self, event_time, key_name):
+        """
+        Record a key press while recording a macro, the first one picks the macro key
+        """
+        if self._current_macro_bind_key is None:
+            # Restrict macro bind keys to M1-M5
+            if key_name not in ('M1', 'M2', 'M3', 'M4', 'M5', 'M6'):
+                self._logger.warning("Macros are only for M1-M6 for now.")
+                self._recording_macro = False
+                self._parent.setMacroMode(False)
+            else:
+                self._current_macro_bind_key = key_name
+                self._parent.setMacroEffect(0x00)
+        # Don't want no recursion, cancel macro, don't let one call macro in a macro
+        elif key_name == self._current_macro_bind_key:
+            self._logger.warning("Skipping macro assignment as would cause recursion")
+            self._recording_macro = False
+            self._parent.setMacroMode(False)
+        # Anything else just record it
+        else:
+            self._current_macro_combo.append((event_time, key_name, 'DOWN'))
+
+    def _play_macro_key(self, event_time, key_name):
+        self.play_macro(key_name)
+
     def add_kb_macro(self):
         """
         Tidy up the recorded macro and add it to the store
@@ -498,41 +602,23 @@ class KeyboardKeyManager(object):
 
         start_time = self._current_macro_combo[0][0]
         for event_time, key, state in self._current_macro_combo:
-            delay = (event_time - start_time).microseconds
+            delay = (event_time - start_time) // 1000
             start_time = event_time
             new_macro.append(MacroKey(key, delay, state))
 
-        self._macros[self._current_macro_bind_key] = new_macro
-
-    def clean_macro_threads(self):
-        """
-        Threadless-threadpool
-
-        Goes though the threads (macro play jobs) and removed the threads if they have finished.
-        #SetMagic
-        """
-        self._logger.debug("Cleaning up macro threads")
-        to_remove = set()
-
-        for macro_thread in self._threads:
-            macro_thread.join(timeout=0.05)
-            if not macro_thread.is_alive():
-                to_remove.add(macro_thread)
-
-        self._threads -= to_remove
+        self._macros[self._current_macro_bind_key] = MacroRunner(self._device_id, self._current_macro_bind_key, new_macro)
+        self._update_key_actions()
 
     def play_macro(self, macro_key):
         """
         Play macro for a given key
 
-        Launches a thread and adds it to the pool
+        Queues the compiled macro on the macro workers
         :param macro_key: Macro Key
         :type macro_key: str
         """
         self._logger.info("Running Macro %s:%s", macro_key, str(self._macros[macro_key]))
-        macro_thread = MacroRunner(self._device_id, macro_key, self._macros[macro_key])
-        macro_thread.start()
-        self._threads.add(macro_thread)
+        self._macros[macro_key].play()
 
     # Methods to be used with DBus
     def dbus_delete_macro(self, key_name):
@@ -546,6 +632,8 @@ class KeyboardKeyManager(object):
             del self._macros[key_name]
         except KeyError:
             pass
+        else:
+            self._update_key_actions()
 
     def dbus_get_macros(self):
         """
@@ -562,7 +650,7 @@ class KeyboardKeyManager(object):
         """
         result_dict = {}
         for macro_key, macro_combo in self._macros.items():
-            str_combo = [value.to_dict() for value in macro_combo]
+            str_combo = [value.to_dict() for value in macro_combo.macro_data]
             result_dict[macro_key] = str_combo
 
         return json.dumps(result_dict)
@@ -571,7 +659,8 @@ class KeyboardKeyManager(object):
         """
         Add macro from JSON
 
-        The macro_json will be a list of macro objects which is then converted into JSON
+        The macro_json will be a list of macro objects which is then converted into JSON.
+        The macro is compiled for playback here, not when it's played.
         :param macro_key: Macro bind key
         :type macro_key: str
 
@@ -579,7 +668,8 @@ class KeyboardKeyManager(object):
         :type macro_json: str
         """
         macro_list = [macro_dict_to_obj(macro_object_dict) for macro_object_dict in json.loads(macro_json)]
-        self._macros[macro_key] = macro_list
+        self._macros[macro_key] = MacroRunner(self._device_id, macro_key, macro_list)
+        self._update_key_actions()
 
     def close(self):
         """
@@ -589,10 +679,8 @@ class KeyboardKeyManager(object):
             self._parent.remove_observer(self)
 
             self._logger.debug("Stopping key manager")
-            self._keywatcher.shutdown = True
-            self._keywatcher.join(timeout=2)
-            if self._keywatcher.is_alive():
-                self._logger.error("Could not stop KeyWatcher thread")
+
+        self._keywatcher.close()
 
     def __del__(self):
         self.close()
@@ -628,13 +716,43 @@ class GamepadKeyManager(KeyboardKeyManager):
     GAMEPAD_KEY_MAPPING = TARTARUS_KEY_MAPPING
 
     def __init__(self, device_id, event_files, parent, use_epoll=True, testing=False):
-        super().__init__(device_id, event_files, parent, use_epoll, testing=testing)
-
+        # Set before the base class builds the key dispatch table
         self._mode_modifier = False
         self._mode_modifier_combo = []
         self._mode_modifier_key_down = False
 
-    def key_action(self, event_time, key_id, key_press=True):
+        super().__init__(device_id, event_files, parent, use_epoll, testing=testing)
+
+    def _update_key_actions(self):
+        """
+        Rebuild the key dispatch table
+
+        The modifier state is the event type, only presses of macro keys and
+        MODE_SWITCH (when it's a modifier) do anything. Has to be called
+        whenever the macros or the mode modifier change.
+        """
+        key_actions = {}
+
+        for key_name in self._macros:
+            key_actions[(key_name, 'press')] = self._play_macro_key
+
+        if self._mode_modifier:
+            key_actions[('MODE_SWITCH', 'press')] = self._mode_switch_down
+            key_actions[('MODE_SWITCH', 'release')] = self._mode_switch_up
+
+        self._key_actions = key_actions
+
+    def _mode_switch_down(self, event_time, key_name):
+        # Start the macro string
+        self._mode_modifier_key_down = True
+        self._mode_modifier_combo.clear()
+        self._mode_modifier_combo.append('MODE')
+
+    def _mode_switch_up(self, event_time, key_name):
+        # Release mode_switch
+        self._mode_modifier_key_down = False
+
+    def key_action(self, event_time, key_id, key_press='press'):
         """
         Process a key press event
 
@@ -645,77 +763,51 @@ class GamepadKeyManager(KeyboardKeyManager):
           then it will record keys, then pressing FN+F9 will save macro.
         * Pressing any macro key will run macro.
         * Pressing FN+F10 will toggle game mode.
-        :param event_time: Time event occurred
-        :type event_time: datetime.datetime
+        :param event_time: Time event occurred in ns
+        :type event_time: int
 
         :param key_id: Key Event ID
         :type key_id: int
 
-        :param key_press: If true then its a press, else its a release
-        :type key_press: bool
+        :param key_press: Can either be press, release, autorepeat
+        :type key_press: str
         """
-        # Disable pylints complaining for this part, #PerformanceOverNeatness
-        # pylint: disable=too-many-branches,too-many-statements
+        # Still accept the old True/False, truthiness can't tell the KeyWatcher's strings apart
+        if key_press is True:
+            key_press = 'press'
+        elif key_press is False:
+            key_press = 'release'
+
         self._access_lock.acquire()
 
         if not self._event_files_locked:
             self.grab_event_files(True)
 
-        now = datetime.datetime.now()
+        now = time.monotonic_ns()
 
         # Remove expired keys from store
-        try:
-            # Get date and if its less than now its expired
-            while self._temp_key_store[0][0] < now:
-                self._temp_key_store.pop(0)
-        except IndexError:
-            pass
-
-        # Clean up any threads
-        if self._clean_counter > 20 and len(self._threads) > 0:
-            self._clean_counter = 0
-            self.clean_macro_threads()
+        self._temp_key_store.expire(now)
 
         try:
             # Convert event ID to key name
-
             key_name = self.GAMEPAD_EVENT_MAPPING[key_id]
-            # Key press
 
             if self._temp_key_store_active:
                 colour = random_colour_picker(self._last_colour_choice, COLOUR_CHOICES)
                 self._last_colour_choice = colour
                 self._temp_key_store.append((now + self._temp_expire_time, self.GAMEPAD_KEY_MAPPING[key_name], colour))
 
-            # if self._testing:
-            # if key_press:
-                # self._logger.debug("Got Key: {0} Down".format(key_name))
-            # else:
-                # self._logger.debug("Got Key: {0} Up".format(key_name))
-
-            # Logic for mode switch modifier
-            if self._mode_modifier:
-                if key_name == 'MODE_SWITCH' and key_press:
-                    # Start the macro string
-                    self._mode_modifier_key_down = True
-                    self._mode_modifier_combo.clear()
-                    self._mode_modifier_combo.append('MODE')
+            # Any keys pressed whilst mode_switch is down
+            if self._mode_modifier_key_down and key_press == 'press' and key_name != 'MODE_SWITCH':
+                self._mode_modifier_combo.append(key_name)
 
-                elif key_name == 'MODE_SWITCH' and not key_press:
-                    # Release mode_switch
-                    self._mode_modifier_key_down = False
+                # Override keyname so it now equals a macro
+                key_name = '+'.join(self._mode_modifier_combo)
+                self._logger.debug("Macro String: {0}".format(key_name))
 
-                elif key_press and self._mode_modifier_key_down:
-                    # Any keys pressed whilst mode_switch is down
-                    self._mode_modifier_combo.append(key_name)
-
-                    # Override keyname so it now equals a macro
-                    key_name = '+'.join(self._mode_modifier_combo)
-
-            self._logger.debug("Macro String: {0}".format(key_name))
-
-            if key_name in self._macros and key_press:
-                self.play_macro(key_name)
+            handler = self._key_actions.get((key_name, key_press))
+            if handler is not None:
+                handler(event_time, key_name)
 
         except KeyError as err:
             self._logger.exception("Got key error. Couldn't convert event to key name", exc_info=err)
@@ -741,6 +833,8 @@ class GamepadKeyManager(KeyboardKeyManager):
         :type value: bool
         """
         self._mode_modifier = True if value else False
+        self._mode_modifier_key_down = False
+        self._update_key_actions()
 
 
 class OrbweaverKeyManager(GamepadKeyManager):
@@ -5,17 +5,101 @@ Macro stuff
 
 Has objects representing key events
 Launching programs etc...
+
+Key events are typed on a uinput virtual keyboard, which works without X.
+If /dev/uinput can't be opened they are fed to xte instead. The udev rules
+don't give the daemon's user access to /dev/uinput, anyone able to write it
+can inject input into every session, so that's left to the administrator.
 """
+import concurrent.futures
+import fcntl
 import logging
+import os
+import struct
 import subprocess
 import threading
+import time
 
 # pylint: disable=import-error
-from openrazer_daemon.keyboard import XTE_MAPPING
+from openrazer_daemon.keyboard import XTE_MAPPING, EVENT_MAPPING
 
 # This determines if the macro keys are executed with their natural spacing
 XTE_SLEEP = False
 
+# linux/uinput.h and linux/input-event-codes.h
+UI_SET_EVBIT = 0x40045564
+UI_SET_KEYBIT = 0x40045565
+UI_DEV_SETUP = 0x405c5503
+UI_DEV_CREATE = 0x5501
+UI_DEV_DESTROY = 0x5502
+BUS_VIRTUAL = 0x06
+EV_SYN = 0x00
+EV_KEY = 0x01
+SYN_REPORT = 0x00
+
+INPUT_EVENT_FORMAT = '@llHHi'
+UINPUT_SETUP_FORMAT = '@HHHH80sI'
+
+# Key name to input event code, keys that aren't typed (FN, GAMEMODE...) are left out
+KEY_CODES = {name: code for code, name in EVENT_MAPPING.items() if XTE_MAPPING.get(name, name) is not None}
+
+
+class UinputKeyboard(object):
+    """
+    Virtual keyboard macros are typed on, shared by all devices
+    """
+    _lock = threading.Lock()
+    _instance = None
+    _failed = False
+
+    @classmethod
+    def get(cls):
+        """
+        Get the virtual keyboard, creating it on first use
+
+        :return: Keyboard or None if uinput isn't usable
+        :rtype: UinputKeyboard or None
+        """
+        with cls._lock:
+            if cls._instance is None and not cls._failed:
+                try:
+                    cls._instance = cls()
+                except OSError as err:
+                    logging.getLogger('razer.macro').info("Can't use /dev/uinput (%s), falling back to xte for macros", err)
+                    cls._failed = True
+
+        return cls._instance
+
+    def __init__(self):
+        self._fd = os.open('/dev/uinput', os.O_WRONLY | os.O_NONBLOCK | os.O_CLOEXEC)
+
+        try:
+            fcntl.ioctl(self._fd, UI_SET_EVBIT, EV_KEY)
+            for code in KEY_CODES.values():
+                fcntl.ioctl(self._fd, UI_SET_KEYBIT, code)
+
+            fcntl.ioctl(self._fd, UI_DEV_SETUP, struct.pack(UINPUT_SETUP_FORMAT, BUS_VIRTUAL, 0x1532, 0x0000, 1, b'OpenRazer Macro Keyboard', 0))
+            fcntl.ioctl(self._fd, UI_DEV_CREATE)
+        except OSError:
+            os.close(self._fd)
+            raise
+
+    def write(self, events):
+        """
+        Write input events
+
+        :param events: Packed input events
+        :type events: bytes
+        """
+        os.write(self._fd, events)
+
+    def close(self):
+        """
+        Remove the virtual keyboard
+        """
+        fcntl.ioctl(self._fd, UI_DEV_DESTROY)
+        os.close(self._fd)
+
 
 class MacroObject(object):
     """
@@ -79,6 +163,21 @@ class MacroKey(MacroObject):
         """
         return XTE_MAPPING.get(self.key_id, self.key_id)
 
+    @property
+    def input_events(self):
+        """
+        Convert key to packed input events for uinput, the key event and a sync
+
+        :return: Input events or None if the key isn't typed
+        :rtype: bytes or None
+        """
+        code = KEY_CODES.get(self.key_id)
+        if code is None:
+            return None
+
+        return struct.pack(INPUT_EVENT_FORMAT, 0, 0, EV_KEY, code, 0 if self.state == 'UP' else 1) + \
+            struct.pack(INPUT_EVENT_FORMAT, 0, 0, EV_SYN, SYN_REPORT, 0)
+
 # If it only opens a new tab in chroma - https://askubuntu.com/questions/540939/xdg-open-only-opens-a-new-tab-in-a-new-chromium-window-despite-passing-it-a-url
 
 
@@ -106,8 +205,7 @@ class MacroURL(MacroObject):
         """
         Open URL in the browser
         """
-        proc = subprocess.Popen(['xdg-open', self.url], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
-        proc.communicate()
+        start_detached(['xdg-open', self.url])
 
 
 class MacroScript(MacroObject):
@@ -139,22 +237,29 @@ class MacroScript(MacroObject):
         """
         Run script
         """
-        proc = subprocess.Popen(self.script + self.args, shell=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
-        proc.communicate()
+        start_detached(['sh', '-c', self.script + self.args])
 
 
-class MacroRunner(threading.Thread):
+class MacroRunner(object):
     """
-    Thread to run macros
+    Macro compiled for playback
+
+    Built once when a macro is bound. Key events are packed for uinput and
+    turned into xte scripts up front, a key press only replays them on one
+    of the shared macro workers.
     """
 
     def __init__(self, device_id, macro_bind, macro_data):
-        super().__init__()
-
         self._logger = logging.getLogger('razer.device{0}.macro{1}'.format(device_id, macro_bind))
-        self._macro_data = macro_data
         self._macro_bind = macro_bind
 
+        self.macro_data = tuple(macro_data)
+        self._uinput_steps = self._compile_uinput(self.macro_data)
+        self._xte_steps = self._compile_xte(self.macro_data)
+
+    def __repr__(self):
+        return str(list(self.macro_data))
+
     @staticmethod
     def xte_line(key_event):
         """
@@ -182,33 +287,146 @@ class MacroRunner(threading.Thread):
 
         return cmd
 
-    def run(self):
+    @staticmethod
+    def _compile_uinput(macro_data):
         """
-        Main thread function
+        Pack the key events for uinput
+
+        :return: Tuple of (pause in seconds, input events) for keys and (None, object) for everything else
+        :rtype: tuple
+        """
+        steps = []
+
+        for event in macro_data:
+            if isinstance(event, MacroKey):
+                input_events = event.input_events
+                if input_events is None:
+                    continue
+
+                # Keys without a pause before them go out in the same write
+                if event.pre_pause == 0 and steps and steps[-1][0] is not None:
+                    steps[-1] = (steps[-1][0], steps[-1][1] + input_events)
+                else:
+                    steps.append((event.pre_pause / 1000000, input_events))
+            else:
+                steps.append((None, event))
+
+        return tuple(steps)
+
+    @classmethod
+    def _compile_xte(cls, macro_data):
         """
+        Turn runs of key events into xte scripts
 
-        # TODO move the xte-munging to the init
+        :return: Tuple of xte scripts and other macro objects
+        :rtype: tuple
+        """
+        steps = []
         xte = ''
 
-        for event in self._macro_data:
+        for event in macro_data:
             if isinstance(event, MacroKey):
-                xte += self.xte_line(event)
+                xte += cls.xte_line(event)
             else:
+                # This just allows for less calls to xte
                 if xte != '':
-                    proc = subprocess.Popen(['xte'], stdin=subprocess.PIPE)
-                    proc.communicate(input=xte.encode('ascii'))
+                    steps.append(xte.encode('ascii'))
                     xte = ''
-
-                # Now run everything else (this just allows for less calls to xte
-                if not isinstance(event, MacroKey):
-                    event.execute()
+                steps.append(event)
 
         if xte != '':
-            proc = subprocess.Popen(['xte'], stdin=subprocess.PIPE)
-            proc.communicate(input=xte.encode('ascii'))
+            steps.append(xte.encode('ascii'))
+
+        return tuple(steps)
+
+    def play(self):
+        """
+        Queue the macro on the macro workers
+        """
+        future = _macro_workers.submit(self.run)
+        future.add_done_callback(self._check_result)
+
+    def _check_result(self, future):
+        """
+        Log anything run() didn't handle, the pool would keep it to itself
+
+        :param future: Future of run()
+        :type future: concurrent.futures.Future
+        """
+        if not future.cancelled() and future.exception() is not None:
+            self._logger.error("Failed to run macro %s", self._macro_bind, exc_info=future.exception())
+
+    def run(self):
+        """
+        Play the macro on the calling thread
+        """
+        try:
+            keyboard = UinputKeyboard.get()
+            if keyboard is not None:
+                self._run_uinput(keyboard)
+            else:
+                self._run_xte()
+        except OSError as err:
+            self._logger.error("Failed to run macro %s: %s", self._macro_bind, err)
+            return
 
         self._logger.debug("Finished running macro %s", self._macro_bind)
 
+    def _run_uinput(self, keyboard):
+        """
+        Type the macro on the virtual keyboard, keeping the pauses between keys
+
+        :param keyboard: Virtual keyboard
+        :type keyboard: UinputKeyboard
+        """
+        deadline = time.monotonic()
+
+        for pause, step in self._uinput_steps:
+            if pause is None:
+                step.execute()
+                deadline = time.monotonic()
+                continue
+
+            # Sleep to absolute times so the pauses don't add up
+            if pause:
+                deadline += pause
+                delay = deadline - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+
+            keyboard.write(step)
+
+    def _run_xte(self):
+        """
+        Feed the macro to xte
+        """
+        for step in self._xte_steps:
+            if isinstance(step, bytes):
+                proc = subprocess.Popen(['xte'], stdin=subprocess.PIPE)
+                proc.communicate(input=step)
+            else:
+                step.execute()
+
+
+def start_detached(args):
+    """
+    Start a program without waiting for it
+
+    It's started from a shell that exits right away, so the program gets
+    reparented and the macro workers neither wait for it nor have to reap it.
+
+    :param args: Program and its arguments
+    :type args: list
+    """
+    proc = subprocess.Popen(['sh', '-c', '"$@" &', 'sh'] + args,
+                            stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    proc.wait()
+
+
+# Macros play on a few shared threads, presses queue up while they are all busy
+MACRO_WORKERS = 4
+_macro_workers = concurrent.futures.ThreadPoolExecutor(max_workers=MACRO_WORKERS, thread_name_prefix='razer-macro')
+
 
 def macro_dict_to_obj(macro_dict):
     """
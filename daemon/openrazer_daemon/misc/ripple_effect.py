@@ -3,14 +3,18 @@
 """
 Contains the functions and classes to perform ripple effects
 """
-import datetime
 import logging
-import math
 import threading
 import time
 
+import numpy as np
+
 # pylint: disable=import-error
-from openrazer_daemon.keyboard import KeyboardColour
+from openrazer_daemon.misc.frame_scheduler import FrameScheduler
+from openrazer_daemon.misc.key_event_management import KEY_EXPIRE_TIME
+
+# Width of a ripple ring in keys
+RIPPLE_WIDTH = 2
 
 
 class RippleEffectThread(threading.Thread):
@@ -34,7 +38,83 @@ class RippleEffectThread(threading.Thread):
 
         self._rows, self._cols = self._parent._parent.MATRIX_DIMS
 
-        self._keyboard_grid = KeyboardColour(self._rows, self._cols)
+        # Frame in driver format, each row is the row id, start and end column then RGB per column
+        self._frame = np.zeros((self._rows, 3 + self._cols * 3), dtype=np.uint8)
+        self._frame[:, 0] = np.arange(self._rows)
+        self._frame[:, 2] = self._cols - 1
+        self._pixels = self._frame[:, 3:].reshape(self._rows, self._cols, 3)
+        self._payload = memoryview(self._frame.reshape(-1))
+
+        self._init_grid()
+
+    def _init_grid(self):
+        """
+        Work out which keys ripples are drawn on and the distance between all of them
+
+        The logo of 6x22 keyboards is physically at (6, 11) but logically at
+        (0, 20), so it is measured from a virtual 7th row and drawn at (0, 20).
+        """
+        cells = [(row, col, row, col) for row in range(self._rows) for col in range(self._cols)]
+
+        if self._rows == 6 and self._cols == 22:
+            cells.remove((0, 20, 0, 20))
+            cells.append((6, 11, 0, 20))
+
+        cells = np.array(cells)
+        self._cell_rows, self._cell_cols = cells[:, 0], cells[:, 1]
+        self._draw_rows, self._draw_cols = cells[:, 2], cells[:, 3]
+
+        # Distance from every key a ripple can start at to every cell
+        centre_rows, centre_cols = np.mgrid[0:self._rows + 1, 0:self._cols]
+        self._distances = np.hypot(centre_rows[..., None] - self._cell_rows, centre_cols[..., None] - self._cell_cols)
+
+    def _distances_from(self, centres):
+        """
+        Get the distances of all cells from the ripple centres
+
+        :param centres: Array of (row, col) of each ripple
+        :type centres: numpy.ndarray
+
+        :return: Array of distances, one row per ripple
+        :rtype: numpy.ndarray
+        """
+        rows, cols = centres[:, 0], centres[:, 1]
+        if rows.min() >= 0 and cols.min() >= 0 and rows.max() < self._distances.shape[0] and cols.max() < self._distances.shape[1]:
+            return self._distances[rows, cols]
+
+        return np.hypot(rows[:, None] - self._cell_rows, cols[:, None] - self._cell_cols)
+
+    def _render(self, now, key_list):
+        """
+        Draw all ripples into the frame
+
+        A key takes the colour of the oldest ripple whose ring it is in.
+
+        :param now: Current monotonic time in ns
+        :type now: int
+
+        :param key_list: Tuples of expire time, key position and colour
+        :type key_list: tuple
+        """
+        if not key_list:
+            self._pixels.fill(0)
+            return
+
+        expire_times, centres, colours = zip(*key_list)
+
+        # Current radius is based off a time metric
+        radiuses = (now - (np.array(expire_times, dtype=np.int64) - KEY_EXPIRE_TIME)) * (24 / 1000000000)
+        if self._colour is not None:
+            colours = (self._colour,) * len(colours)
+
+        distances = self._distances_from(np.array(centres))
+        hits = (distances <= radiuses[:, None]) & (distances >= radiuses[:, None] - RIPPLE_WIDTH)
+
+        # argmax gives the first ripple hitting each cell, cells no ripple hits stay black
+        cell_colours = np.array(colours, dtype=np.uint8)[hits.argmax(axis=0)]
+        cell_colours[~hits.any(axis=0)] = 0
+
+        self._pixels[self._draw_rows, self._draw_cols] = cell_colours
 
     @property
     def shutdown(self):
@@ -101,73 +181,22 @@ class RippleEffectThread(threading.Thread):
         """
         Event loop
         """
-        # pylint: disable=too-many-nested-blocks,too-many-branches
-        expire_diff = datetime.timedelta(seconds=2)
-
-        # self._parent: RippleManager
-        # self._parent._parent: The device class (e.g. RazerBlackWidowUltimate2013)
-        if self._rows == 6 and self._cols == 22:
-            needslogohandling = True
-            # a virtual 7th row for logo handling
-            self._rows += 1
-        else:
-            needslogohandling = False
+        scheduler = FrameScheduler(self._logger, self._refresh_rate)
 
-        # TODO time execution and then sleep for _refresh_rate - time_taken
         while not self._shutdown:
             if self._active:
-                # Clear keyboard
-                self._keyboard_grid.reset_rows()
-
-                now = datetime.datetime.now()
-
-                radiuses = []
-
-                for expire_time, (key_row, key_col), colour in self.key_list:
-                    event_time = expire_time - expire_diff
-
-                    now_diff = now - event_time
-
-                    # Current radius is based off a time metric
-                    if self._colour is not None:
-                        colour = self._colour
-                    radiuses.append((key_row, key_col, now_diff.total_seconds() * 24, colour))
-
-                # Iterate through the rows
-                for row in range(0, self._rows):
-                    # Iterate through the columns
-                    for col in range(0, self._cols):
-                        # The logo location is physically at (6, 11), logically at (0, 20)
-                        # Skip when we come across the logo location, as the ripple would look wrong
-                        if needslogohandling and row == 0 and col == 20:
-                            continue
-
-                        if needslogohandling and row == 6:
-                            if col != 11:
-                                continue
-
-                            # To account for logo placement
-                            for cirlce_centre_row, circle_centre_col, rad, colour in radiuses:
-                                radius = math.sqrt(math.pow(cirlce_centre_row - row, 2) + math.pow(circle_centre_col - col, 2))
-                                if rad >= radius >= rad - 2:
-                                    # Again, (0, 20) is the logical location of the logo led
-                                    self._keyboard_grid.set_key_colour(0, 20, colour)
-                                    break
-                        else:
-                            for cirlce_centre_row, circle_centre_col, rad, colour in radiuses:
-                                radius = math.sqrt(math.pow(cirlce_centre_row - row, 2) + math.pow(circle_centre_col - col, 2))
-                                if rad >= radius >= rad - 2:
-                                    self._keyboard_grid.set_key_colour(row, col, colour)
-                                    break
+                self._render(time.monotonic_ns(), self.key_list)
 
                 # Set the colors on the device
-                payload = self._keyboard_grid.get_total_binary()
-
-                self._parent.set_rgb_matrix(payload)
+                self._parent.set_rgb_matrix(self._payload)
                 self._parent.refresh_keyboard()
 
-            # Sleep until the next ripple refresh
-            time.sleep(self._refresh_rate)
+                # Sleep until the next ripple refresh
+                scheduler.interval = self._refresh_rate
+                scheduler.wait()
+            else:
+                scheduler.reset()
+                time.sleep(self._refresh_rate)
 
 
 class RippleManager(object):
@@ -190,8 +219,8 @@ class RippleManager(object):
         """
         Get the list of keys from the key manager
 
-        :return: List of tuples (expire_time, (key_row, key_col), random_colour)
-        :rtype: list of tuple
+        :return: Tuples (expire_time in ns, (key_row, key_col), random_colour)
+        :rtype: tuple of tuple
         """
         result = []
         if hasattr(self._parent, 'key_manager'):
@@ -204,15 +233,17 @@ class RippleManager(object):
         Set the LED matrix on the keyboard
 
         :param payload: Binary payload
-        :type payload: bytes
+        :type payload: bytes or memoryview
         """
-        self._parent._set_key_row(payload)
+        # The payload is rendered into again for the next frame, queue a copy
+        payload = bytes(payload)
+        self._parent.queue_write(self._parent._key_row_key(payload), self._parent._set_key_row, payload)
 
     def refresh_keyboard(self):
         """
         Refresh the keyboard
         """
-        self._parent._set_custom_effect()
+        self._parent.queue_write(('set_custom_effect',), self._parent._set_custom_effect)
 
     def notify(self, msg):
         """
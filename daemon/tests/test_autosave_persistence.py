@@ -0,0 +1,60 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import threading
+import time
+import unittest
+import unittest.mock
+
+import openrazer_daemon.misc.autosave_persistence
+
+DELAY = 0.1
+MAX_DELAY = 0.3
+
+
+class PersistenceAutoSaveTest(unittest.TestCase):
+    def setUp(self):
+        self.saves = []
+        self.saved = threading.Event()
+
+        self.autosave = openrazer_daemon.misc.autosave_persistence.PersistenceAutoSave(
+            'persistence.conf', unittest.mock.MagicMock(), DELAY, MAX_DELAY, self.save)
+        self.autosave.start()
+
+    def tearDown(self):
+        self.autosave.close()
+
+    def save(self, persistence_file, sections):
+        self.saves.append((time.monotonic(), persistence_file, sections))
+        self.saved.set()
+
+    def test_changes_written_together(self):
+        self.autosave.mark_changed('device1')
+        self.autosave.mark_changed('device2')
+        last_change = time.monotonic()
+
+        self.assertTrue(self.saved.wait(5))
+        self.assertEqual(len(self.saves), 1)
+
+        save_time, persistence_file, sections = self.saves[0]
+        self.assertEqual(persistence_file, 'persistence.conf')
+        self.assertSetEqual(sections, {'device1', 'device2'})
+        self.assertGreaterEqual(save_time - last_change, DELAY)
+
+    def test_max_delay(self):
+        first_change = time.monotonic()
+
+        # Changes keep coming in faster than the delay
+        while not self.saved.is_set() and time.monotonic() - first_change < 5:
+            self.autosave.mark_changed('device1')
+            time.sleep(DELAY / 4)
+
+        self.assertTrue(self.saved.is_set())
+        self.assertGreaterEqual(self.saves[0][0] - first_change, MAX_DELAY)
+        self.assertLess(self.saves[0][0] - first_change, MAX_DELAY + 1)
+
+    def test_close_drops_pending(self):
+        self.autosave.mark_changed('device1')
+        self.autosave.close()
+
+        self.assertFalse(self.autosave.is_alive())
+        self.assertListEqual(self.saves, [])
@@ -0,0 +1,93 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import threading
+import unittest
+
+import openrazer_daemon.misc.device_writer
+
+
+class DeviceWriterTest(unittest.TestCase):
+    def setUp(self):
+        self.writer = openrazer_daemon.misc.device_writer.DeviceWriter(0)
+        self.writer.start()
+
+        self.calls = []
+        self.started = threading.Event()
+        self.release = threading.Event()
+        self.done = threading.Event()
+
+    def tearDown(self):
+        self.release.set()
+        self.writer.close()
+
+    def write(self, name):
+        self.calls.append(name)
+
+    def blocking_write(self):
+        self.calls.append('blocking')
+        self.started.set()
+        self.release.wait(5)
+
+    def block_writer(self):
+        # Keep the writer busy so writes queued after this stay pending
+        self.writer.submit(('blocking',), self.blocking_write)
+        self.assertTrue(self.started.wait(5))
+
+    def test_writes_run_in_order(self):
+        self.writer.submit(('a',), self.write, 'a')
+        self.writer.submit(('b',), self.write, 'b')
+        self.writer.submit(('done',), self.done.set)
+
+        self.assertTrue(self.done.wait(5))
+        self.assertListEqual(self.calls, ['a', 'b'])
+
+    def test_pending_write_replaced(self):
+        self.block_writer()
+
+        self.writer.submit(('a',), self.write, 'a1')
+        self.writer.submit(('b',), self.write, 'b')
+        # Replaces a1 and moves to the back of the queue
+        self.writer.submit(('a',), self.write, 'a2')
+        self.writer.submit(('done',), self.done.set)
+
+        self.release.set()
+        self.assertTrue(self.done.wait(5))
+        self.assertListEqual(self.calls, ['blocking', 'b', 'a2'])
+
+    def test_cancel_drops_pending_writes(self):
+        self.block_writer()
+
+        self.writer.submit(('a',), self.write, 'a')
+        # Cancel while the blocking write is still running, or the writer could already have run a
+        cancel_thread = threading.Thread(target=self.writer.cancel)
+        cancel_thread.start()
+        cancel_thread.join(0.1)
+        self.release.set()
+        cancel_thread.join(5)
+
+        self.writer.submit(('done',), self.done.set)
+        self.assertTrue(self.done.wait(5))
+        self.assertListEqual(self.calls, ['blocking'])
+
+    def test_cancel_waits_for_running_write(self):
+        self.block_writer()
+
+        cancel_thread = threading.Thread(target=self.writer.cancel)
+        cancel_thread.start()
+        cancel_thread.join(0.1)
+        self.assertTrue(cancel_thread.is_alive())
+
+        self.release.set()
+        cancel_thread.join(5)
+        self.assertFalse(cancel_thread.is_alive())
+
+    def test_failed_write_doesnt_stop_writer(self):
+        def fail():
+            raise OSError('test')
+
+        self.writer.submit(('fail',), fail)
+        self.writer.submit(('a',), self.write, 'a')
+        self.writer.submit(('done',), self.done.set)
+
+        self.assertTrue(self.done.wait(5))
+        self.assertListEqual(self.calls, ['a'])
@@ -62,6 +62,24 @@ class DummyHardwareBlackWidowChroma(DummyHardwareDevice):
         self.effect_call = ('setBreathSingle', red, green, blue)
 
 
+class DummyHardwareZoned(DummyHardwareDevice):
+    def __init__(self):
+        super().__init__()
+        self.effect_calls = []
+
+    def setPulsate(self):
+        self.effect_calls.append(('setPulsate',))
+
+    def setLogoActive(self, active):
+        self.effect_calls.append(('setLogoActive', active))
+
+    def setLogoPulsate(self, red, green, blue):
+        self.effect_calls.append(('setLogoPulsate', red, green, blue))
+
+    def setLogoBreathSingle(self, red, green, blue):
+        self.effect_calls.append(('setLogoBreathSingle', red, green, blue))
+
+
 class EffectSyncTest(unittest.TestCase):
     @unittest.mock.patch('openrazer_daemon.misc.effect_sync.logging.getLogger', logger_mock)
     def setUp(self):
@@ -158,3 +176,36 @@ class EffectSyncTest(unittest.TestCase):
 
         # Logger should have called .exception
         self.assertTrue(self.effect_sync._logger.exception.called)
+
+    def test_notify_run_effect_breath_fan_out(self):
+        # Device with zones and a setPulsate but no setBreathSingle
+        self.hardware_device = DummyHardwareZoned()
+        self.effect_sync._parent = self.hardware_device
+        self.hardware_device.register_observer(self.effect_sync)
+
+        self.effect_sync.notify(MSG4)
+
+        self.assertListEqual(self.hardware_device.effect_calls, [
+            ('setLogoActive', True),
+            ('setPulsate',),
+            ('setLogoPulsate', 0, 255, 0),
+            ('setLogoBreathSingle', 255, 255, 0),
+        ])
+
+    def test_handlers_resolved_once(self):
+        self.hardware_device = DummyHardwareBlackWidowChroma()
+        self.effect_sync._parent = self.hardware_device
+        self.hardware_device.register_observer(self.effect_sync)
+
+        resolve = unittest.mock.MagicMock(wraps=self.effect_sync._resolve_handlers)
+        self.effect_sync._resolve_handlers = resolve
+
+        self.effect_sync.notify(MSG2)
+        self.effect_sync.notify(('effect', None, 'setStatic', 0, 0, 255))
+        self.assertEqual(resolve.call_count, 1)
+        self.assertTupleEqual(self.hardware_device.effect_call, ('setStatic', 0, 0, 255))
+
+        # Same effect with another number of arguments is resolved separately
+        self.effect_sync.notify(MSG3)
+        self.assertEqual(resolve.call_count, 2)
+        self.assertTupleEqual(self.hardware_device.effect_call, ('setStatic', 0, 255, 0))
@@ -0,0 +1,76 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import unittest
+import unittest.mock
+
+import openrazer_daemon.misc.frame_scheduler
+
+
+class FakeClock(object):
+    # Times are multiples of a power of two so the sums are exact
+    def __init__(self):
+        self.now = 0.0
+        self.sleeps = []
+
+    def monotonic(self):
+        return self.now
+
+    def sleep(self, seconds):
+        self.sleeps.append(seconds)
+        self.now += seconds
+
+
+class FrameSchedulerTest(unittest.TestCase):
+    def setUp(self):
+        self.clock = FakeClock()
+
+        patcher = unittest.mock.patch.multiple('openrazer_daemon.misc.frame_scheduler.time',
+                                               monotonic=self.clock.monotonic, sleep=self.clock.sleep)
+        patcher.start()
+        self.addCleanup(patcher.stop)
+
+        self.scheduler = openrazer_daemon.misc.frame_scheduler.FrameScheduler(unittest.mock.MagicMock(), 0.25)
+
+    def test_sleeps_until_deadline(self):
+        self.scheduler.wait()
+        # Rendering the frame takes some time, which is taken off the sleep
+        self.clock.now += 0.0625
+        self.scheduler.wait()
+
+        self.assertListEqual(self.clock.sleeps, [0.25, 0.1875])
+        self.assertEqual(self.clock.now, 0.5)
+
+    def test_skips_missed_frames(self):
+        self.scheduler.wait()
+        # Two and a half frames late
+        self.clock.now += 0.625
+        self.scheduler.wait()
+
+        # Lands on the next deadline still ahead, not right after the missed ones
+        self.assertEqual(self.clock.sleeps[-1], 0.125)
+        self.assertEqual(self.clock.now, 1.0)
+
+        stats = self.scheduler.stats()
+        self.assertEqual(stats['skipped'], 2)
+        self.assertEqual(stats['p50'], 625.0)
+
+    def test_reset_starts_new_schedule(self):
+        self.scheduler.wait()
+        self.scheduler.reset()
+
+        # An idle pause after a reset isn't counted as missed frames
+        self.clock.now += 10
+        self.scheduler.wait()
+
+        self.assertEqual(self.clock.sleeps[-1], 0.25)
+        self.assertEqual(self.scheduler.stats()['skipped'], 0)
+
+    def test_interval_change_resets(self):
+        self.scheduler.wait()
+
+        self.scheduler.interval = 0.5
+        self.clock.now += 1
+        self.scheduler.wait()
+
+        self.assertEqual(self.clock.sleeps[-1], 0.5)
+        self.assertEqual(self.scheduler.stats()['skipped'], 0)
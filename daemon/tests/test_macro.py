@@ -0,0 +1,44 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import unittest
+
+import openrazer_daemon.misc.macro
+from openrazer_daemon.misc.macro import MacroKey, MacroRunner, MacroURL
+
+
+class CompileUinputTest(unittest.TestCase):
+    def test_keys_without_pause_merged(self):
+        keys = [MacroKey('A', 1000, 'DOWN'), MacroKey('A', 0, 'UP'), MacroKey('B', 0, 'DOWN'), MacroKey('B', 0, 'UP')]
+
+        steps = MacroRunner._compile_uinput(keys)
+
+        self.assertEqual(len(steps), 1)
+        self.assertEqual(steps[0][0], 0.001)
+        self.assertEqual(steps[0][1], b''.join(key.input_events for key in keys))
+
+    def test_pause_starts_new_step(self):
+        keys = [MacroKey('A', 0, 'DOWN'), MacroKey('A', 500000, 'UP')]
+
+        steps = MacroRunner._compile_uinput(keys)
+
+        self.assertListEqual([pause for pause, _ in steps], [0, 0.5])
+        self.assertListEqual([events for _, events in steps], [key.input_events for key in keys])
+
+    def test_other_objects_split_runs(self):
+        url = MacroURL('https://openrazer.github.io')
+        keys = [MacroKey('A', 0, 'DOWN'), url, MacroKey('A', 0, 'UP')]
+
+        steps = MacroRunner._compile_uinput(keys)
+
+        self.assertEqual(len(steps), 3)
+        self.assertTupleEqual(steps[1], (None, url))
+        # A key without a pause after another object isn't merged into it
+        self.assertTupleEqual(steps[2], (0, keys[2].input_events))
+
+    def test_untyped_keys_skipped(self):
+        keys = [MacroKey('FN', 0, 'DOWN'), MacroKey('A', 0, 'DOWN')]
+        self.assertNotIn('FN', openrazer_daemon.misc.macro.KEY_CODES)
+
+        steps = MacroRunner._compile_uinput(keys)
+
+        self.assertTupleEqual(steps, ((0, keys[1].input_events),))
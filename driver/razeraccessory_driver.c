@@ -45,38 +45,49 @@ static int razer_get_report(struct hid_device *hdev, struct razer_report *reques
 
 /**
  * Function to send to device, get response, and actually check the response
+ *
+ * If mode isn't RAZER_DEVICE_MODE_UNKNOWN the request puts the device into
+ * that mode. The device mode cache is checked and updated under the device
+ * lock of the attempt that sends it, so the cache can't end up disagreeing
+ * with the device. With skip_cached nothing is sent if the cache already
+ * has the mode.
  */
-static int __must_check razer_send_payload(struct razer_accessory_device *device, struct razer_report *request, struct razer_report *response)
+static int __must_check razer_send_payload_mode(struct razer_accessory_device *device, struct razer_report *request, struct razer_report *response, int mode, bool skip_cached)
 {
+    bool locked;
     int retry;
     int err;
 
     request->crc = razer_calculate_crc(request);
 
     for (retry = 5; retry > 0; retry--) {
-        mutex_lock(&device->lock);
+        locked = razer_device_lock(&device->lock, &device->profile);
+
+        if (skip_cached && device->device_mode == mode) {
+            razer_device_unlock(&device->lock, locked);
+            return 0;
+        }
+
         err = razer_get_report(device->hdev, request, response);
-        mutex_unlock(&device->lock);
         if (err) {
             print_erroneous_report(device->hdev, response, "Invalid Report Length");
-            goto retry;
-        }
-
-        /* Check the packet number, class and command are the same */
-        if (response->remaining_packets != request->remaining_packets ||
-            response->command_class != request->command_class ||
-            response->command_id.id != request->command_id.id) {
+        } else if (response->remaining_packets != request->remaining_packets ||
+                   response->command_class != request->command_class ||
+                   response->command_id.id != request->command_id.id) {
+            /* Check the packet number, class and command are the same */
             print_erroneous_report(device->hdev, response, "Response doesn't match request");
             err = -EINVAL;
-            goto retry;
+        } else if (response->status == RAZER_CMD_SUCCESSFUL ||
+                   response->status == RAZER_CMD_BUSY) {
+            /* Some commands respond with 'busy' but succeed. Treat it as success. */
+            if (mode != RAZER_DEVICE_MODE_UNKNOWN)
+                device->device_mode = mode;
+            razer_device_unlock(&device->lock, locked);
+            return 0;
         }
 
-        /* Some commands respond with 'busy' but succeed. Treat it as success. */
-        if (response->status == RAZER_CMD_SUCCESSFUL ||
-            response->status == RAZER_CMD_BUSY)
-            return 0;
+        razer_device_unlock(&device->lock, locked);
 
-retry:
         hid_dbg(device->hdev,
                 "Sending command failed: %d, response status: %d, retries left: %d\n",
                 err, response->status, retry);
@@ -85,6 +96,11 @@ retry:
         fsleep(10000);
     }
 
+    // A wireless device that dropped off its receiver fails here and comes back in its default mode
+    locked = razer_device_lock(&device->lock, &device->profile);
+    device->device_mode = RAZER_DEVICE_MODE_UNKNOWN;
+    razer_device_unlock(&device->lock, locked);
+
     if (err)
         return err;
 
@@ -106,6 +122,14 @@ retry:
     }
 }
 
+/**
+ * Function to send to device, get response, and actually check the response
+ */
+static int __must_check razer_send_payload(struct razer_accessory_device *device, struct razer_report *request, struct razer_report *response)
+{
+    return razer_send_payload_mode(device, request, response, RAZER_DEVICE_MODE_UNKNOWN, false);
+}
+
 /**
  * Device mode function
  */
@@ -117,7 +141,8 @@ static int razer_set_device_mode(struct razer_accessory_device *device, unsigned
     request = razer_chroma_standard_set_device_mode(mode, param);
     request.transaction_id.id = 0x3F;
 
-    return razer_send_payload(device, &request, &response);
+    // Skip the transfer if the device is already in the requested mode
+    return razer_send_payload_mode(device, &request, &response, RAZER_DEVICE_MODE(mode, param), true);
 }
 
 /**
@@ -1066,6 +1091,7 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
     size_t offset = 0;
     unsigned char row_id, start_col, stop_col;
     size_t row_length;
+    bool locked;
     int err;
 
     while(offset < count) {
@@ -1154,9 +1180,9 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
             break;
 
         case USB_DEVICE_ID_RAZER_CHROMA_ADDRESSABLE_RGB_CONTROLLER:
-            mutex_lock(&device->lock);
+            locked = razer_device_lock(&device->lock, &device->profile);
             razer_send_argb_msg(device->hdev, row_id, (stop_col - start_col) + 1, (unsigned char*)&buf[offset]);
-            mutex_unlock(&device->lock);
+            razer_device_unlock(&device->lock, locked);
             return count;
 
         default:
@@ -1366,7 +1392,7 @@ static ssize_t razer_attr_write_device_mode(struct device *dev, struct device_at
         return -EINVAL;
     }
 
-    err = razer_send_payload(device, &request, &response);
+    err = razer_send_payload_mode(device, &request, &response, RAZER_DEVICE_MODE(buf[0], buf[1]), false);
     if (err)
         return err;
 
@@ -2436,6 +2462,79 @@ static DEVICE_ATTR(channel6_led_brightness,                 0660, razer_attr_rea
 
 static DEVICE_ATTR(is_mug_present,                          0440, razer_attr_read_is_mug_present,                 NULL);
 
+/*
+ * Attributes that can be set through apply_profile
+ */
+static struct device_attribute *const razer_profile_attrs[] = {
+    &dev_attr_matrix_effect_none,
+    &dev_attr_matrix_effect_spectrum,
+    &dev_attr_matrix_effect_static,
+    &dev_attr_matrix_effect_reactive,
+    &dev_attr_matrix_effect_breath,
+    &dev_attr_matrix_effect_custom,
+    &dev_attr_matrix_effect_wave,
+    &dev_attr_matrix_effect_blinking,
+    &dev_attr_matrix_effect_starlight,
+    &dev_attr_matrix_brightness,
+    &dev_attr_matrix_reactive_trigger,
+    &dev_attr_charging_led_brightness,
+    &dev_attr_charging_matrix_effect_wave,
+    &dev_attr_charging_matrix_effect_spectrum,
+    &dev_attr_charging_matrix_effect_breath,
+    &dev_attr_charging_matrix_effect_static,
+    &dev_attr_charging_matrix_effect_none,
+    &dev_attr_fast_charging_led_brightness,
+    &dev_attr_fast_charging_matrix_effect_wave,
+    &dev_attr_fast_charging_matrix_effect_spectrum,
+    &dev_attr_fast_charging_matrix_effect_breath,
+    &dev_attr_fast_charging_matrix_effect_static,
+    &dev_attr_fast_charging_matrix_effect_none,
+    &dev_attr_fully_charged_led_brightness,
+    &dev_attr_fully_charged_matrix_effect_wave,
+    &dev_attr_fully_charged_matrix_effect_spectrum,
+    &dev_attr_fully_charged_matrix_effect_breath,
+    &dev_attr_fully_charged_matrix_effect_static,
+    &dev_attr_fully_charged_matrix_effect_none,
+    &dev_attr_channel1_size,
+    &dev_attr_channel2_size,
+    &dev_attr_channel3_size,
+    &dev_attr_channel4_size,
+    &dev_attr_channel5_size,
+    &dev_attr_channel6_size,
+    &dev_attr_channel1_led_brightness,
+    &dev_attr_channel2_led_brightness,
+    &dev_attr_channel3_led_brightness,
+    &dev_attr_channel4_led_brightness,
+    &dev_attr_channel5_led_brightness,
+    &dev_attr_channel6_led_brightness,
+};
+
+/**
+ * Read device file "apply_profile"
+ *
+ * Returns one "name error" line per item of the last applied profile
+ */
+static ssize_t razer_attr_read_apply_profile(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_accessory_device *device = dev_get_drvdata(dev);
+
+    return razer_profile_show_status(&device->profile, buf);
+}
+
+/**
+ * Write device file "apply_profile"
+ *
+ * Sets several attributes at once, each item is NAME_LEN NAME VALUE_LEN VALUE
+ */
+static ssize_t razer_attr_write_apply_profile(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_accessory_device *device = dev_get_drvdata(dev);
+
+    return razer_profile_apply(dev, razer_profile_attrs, ARRAY_SIZE(razer_profile_attrs), &device->profile, &device->lock, buf, count);
+}
+
+static DEVICE_ATTR(apply_profile, 0660, razer_attr_read_apply_profile, razer_attr_write_apply_profile);
+
 static void razer_accessory_init(struct razer_accessory_device *dev, struct usb_interface *intf, struct hid_device *hdev)
 {
     struct usb_device *usb_dev = interface_to_usbdev(intf);
@@ -2449,10 +2548,13 @@ static void razer_accessory_init(struct razer_accessory_device *dev, struct usb_
     dev->usb_vid = usb_dev->descriptor.idVendor;
     dev->usb_pid = usb_dev->descriptor.idProduct;
     dev->usb_interface_protocol = intf->cur_altsetting->desc.bInterfaceProtocol;
+    dev->device_mode = RAZER_DEVICE_MODE_UNKNOWN;
 
     // Get a "random" integer
     get_random_bytes(&rand_serial, sizeof(unsigned int));
     sprintf(dev->serial, "MUG%012u", rand_serial);
+
+    razer_profile_init(&dev->profile);
 }
 
 /**
@@ -2595,6 +2697,7 @@ static int razer_accessory_probe(struct hid_device *hdev, const struct hid_devic
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_mode);                           // Get string of device mode
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_serial);                         // Get string of device serial
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_firmware_version);                      // Get string of device fw version
+        CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_apply_profile);                         // Sets several attributes at once
 
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);                   // Custom effect frame
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_none);                    // No effect
@@ -2849,6 +2952,7 @@ static void razer_accessory_disconnect(struct hid_device *hdev)
         device_remove_file(&hdev->dev, &dev_attr_device_mode);                           // Get string of device mode
         device_remove_file(&hdev->dev, &dev_attr_device_serial);                         // Get string of device serial
         device_remove_file(&hdev->dev, &dev_attr_firmware_version);                      // Get string of device fw version
+        device_remove_file(&hdev->dev, &dev_attr_apply_profile);                         // Sets several attributes at once
 
         device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);                   // Custom effect frame
         device_remove_file(&hdev->dev, &dev_attr_matrix_effect_none);                    // No effect
@@ -3019,6 +3123,24 @@ static int razer_raw_event(struct hid_device *hdev, struct hid_report *report, u
     return 0;
 }
 
+#ifdef CONFIG_PM
+/**
+ * Forget the cached device mode, the device might have been reset while suspended
+ */
+static int razer_accessory_resume(struct hid_device *hdev)
+{
+    struct razer_accessory_device *device = hid_get_drvdata(hdev);
+
+    if (device) {
+        mutex_lock(&device->lock);
+        device->device_mode = RAZER_DEVICE_MODE_UNKNOWN;
+        mutex_unlock(&device->lock);
+    }
+
+    return 0;
+}
+#endif
+
 /**
  * Device ID mapping table
  */
@@ -3067,7 +3189,11 @@ static struct hid_driver razer_accessory_driver = {
     .remove = razer_accessory_disconnect,
     .raw_event = razer_raw_event,
     .input_mapping = razer_input_mapping,
-    .input_configured = razer_input_configured
+    .input_configured = razer_input_configured,
+#ifdef CONFIG_PM
+    .resume = razer_accessory_resume,
+    .reset_resume = razer_accessory_resume,
+#endif
 };
 
 module_hid_driver(razer_accessory_driver);
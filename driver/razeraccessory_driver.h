@@ -6,6 +6,8 @@
 #ifndef __HID_RAZER_ACCESSORY_H
 #define __HID_RAZER_ACCESSORY_H
 
+#include "razercommon.h"
+
 #define USB_DEVICE_ID_RAZER_FIREFLY_HYPERFLUX 0x0068
 #define USB_DEVICE_ID_RAZER_MOUSE_DOCK 0x007E
 #define USB_DEVICE_ID_RAZER_MOUSE_DOCK_PRO 0x00A4
@@ -49,8 +51,11 @@ struct razer_accessory_device {
     unsigned short usb_pid;
 
     unsigned char saved_brightness;
+    int device_mode;
 
     char serial[23];
+
+    struct razer_profile_status profile;
 };
 
 /*
@@ -9,6 +9,8 @@
 #include <linux/module.h>
 #include <linux/init.h>
 #include <linux/hid.h>
+#include <linux/sched.h>
+#include <linux/sysfs.h>
 
 #include "razercommon.h"
 
@@ -230,3 +232,420 @@ int razer_send_argb_msg(struct hid_device* hdev, unsigned char channel, size_t s
 
     return ret;
 }
+
+#if IS_REACHABLE(CONFIG_POWER_SUPPLY)
+static enum power_supply_property razer_battery_props[] = {
+    POWER_SUPPLY_PROP_PRESENT,
+    POWER_SUPPLY_PROP_STATUS,
+    POWER_SUPPLY_PROP_CAPACITY,
+    POWER_SUPPLY_PROP_CAPACITY_ALERT_MIN,
+    POWER_SUPPLY_PROP_SCOPE,
+    POWER_SUPPLY_PROP_MODEL_NAME,
+    POWER_SUPPLY_PROP_MANUFACTURER,
+};
+
+/**
+ * Report the cached battery state, never talks to the device
+ */
+static int razer_battery_get_property(struct power_supply *psy, enum power_supply_property psp, union power_supply_propval *val)
+{
+    struct razer_battery *battery = power_supply_get_drvdata(psy);
+
+    switch (psp) {
+    case POWER_SUPPLY_PROP_PRESENT:
+        val->intval = 1;
+        break;
+
+    case POWER_SUPPLY_PROP_STATUS:
+        if (battery->status < 0)
+            val->intval = POWER_SUPPLY_STATUS_UNKNOWN;
+        else if (battery->status && battery->level == 255)
+            val->intval = POWER_SUPPLY_STATUS_FULL;
+        else if (battery->status)
+            val->intval = POWER_SUPPLY_STATUS_CHARGING;
+        else
+            val->intval = POWER_SUPPLY_STATUS_DISCHARGING;
+        break;
+
+    case POWER_SUPPLY_PROP_CAPACITY:
+        if (battery->level < 0)
+            return -ENODATA;
+        val->intval = DIV_ROUND_CLOSEST(battery->level * 100, 255);
+        break;
+
+    case POWER_SUPPLY_PROP_CAPACITY_ALERT_MIN:
+        if (battery->low_threshold < 0)
+            return -ENODATA;
+        val->intval = DIV_ROUND_CLOSEST(battery->low_threshold * 100, 255);
+        break;
+
+    case POWER_SUPPLY_PROP_SCOPE:
+        val->intval = POWER_SUPPLY_SCOPE_DEVICE;
+        break;
+
+    case POWER_SUPPLY_PROP_MODEL_NAME:
+        val->strval = battery->hdev->name;
+        break;
+
+    case POWER_SUPPLY_PROP_MANUFACTURER:
+        val->strval = "Razer";
+        break;
+
+    default:
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/**
+ * Register the power_supply device for a device with battery
+ *
+ * Does nothing if it has already been registered.
+ */
+int razer_battery_register(struct razer_battery *battery)
+{
+    struct power_supply_config cfg = { .drv_data = battery };
+    struct power_supply *psy;
+
+    if (battery->psy)
+        return 0;
+
+    // Kept over failed attempts, devm only frees it when the device goes away
+    if (!battery->psy_desc.name) {
+        battery->psy_desc.name = devm_kasprintf(&battery->hdev->dev, GFP_KERNEL, "razer-%s-battery", dev_name(&battery->hdev->dev));
+        if (!battery->psy_desc.name)
+            return -ENOMEM;
+    }
+
+    battery->psy_desc.type = POWER_SUPPLY_TYPE_BATTERY;
+    battery->psy_desc.properties = razer_battery_props;
+    battery->psy_desc.num_properties = ARRAY_SIZE(razer_battery_props);
+    battery->psy_desc.get_property = razer_battery_get_property;
+
+    psy = power_supply_register(&battery->hdev->dev, &battery->psy_desc, &cfg);
+    if (IS_ERR(psy)) {
+        hid_warn(battery->hdev, "Failed to register power supply: %ld\n", PTR_ERR(psy));
+        return PTR_ERR(psy);
+    }
+
+    power_supply_powers(psy, &battery->hdev->dev);
+    battery->psy = psy;
+
+    return 0;
+}
+
+static void razer_battery_changed(struct razer_battery *battery)
+{
+    if (battery->psy)
+        power_supply_changed(battery->psy);
+}
+
+static void razer_battery_unregister(struct razer_battery *battery)
+{
+    if (battery->psy) {
+        power_supply_unregister(battery->psy);
+        battery->psy = NULL;
+    }
+}
+#else
+int razer_battery_register(struct razer_battery *battery)
+{
+    return 0;
+}
+
+static void razer_battery_changed(struct razer_battery *battery)
+{
+}
+
+static void razer_battery_unregister(struct razer_battery *battery)
+{
+}
+#endif
+
+/**
+ * Initialise the battery state, the work is not scheduled yet
+ */
+void razer_battery_init(struct razer_battery *battery, struct hid_device *hdev, work_func_t func)
+{
+    battery->hdev = hdev;
+    battery->level = -1;
+    battery->status = -1;
+    battery->low_threshold = -1;
+    INIT_DELAYED_WORK(&battery->work, func);
+}
+
+/**
+ * Stop refreshing the battery state and remove the power_supply device
+ */
+void razer_battery_stop(struct razer_battery *battery)
+{
+    cancel_delayed_work_sync(&battery->work);
+    razer_battery_unregister(battery);
+}
+
+/**
+ * Get the battery level if it has been read recently enough
+ */
+bool razer_battery_get_cached_level(struct razer_battery *battery, u8 *level)
+{
+    if (battery->level < 0 || time_after(jiffies, battery->level_updated + msecs_to_jiffies(RAZER_BATTERY_CACHE_MS)))
+        return false;
+
+    *level = battery->level;
+    return true;
+}
+
+/**
+ * Get the charging status if it has been read recently enough
+ */
+bool razer_battery_get_cached_status(struct razer_battery *battery, u8 *status)
+{
+    if (battery->status < 0 || time_after(jiffies, battery->status_updated + msecs_to_jiffies(RAZER_BATTERY_CACHE_MS)))
+        return false;
+
+    *status = battery->status;
+    return true;
+}
+
+/**
+ * Store the battery level and wake up pollers of "charge_level" if it changed
+ */
+void razer_battery_set_level(struct razer_battery *battery, u8 level)
+{
+    battery->level_updated = jiffies;
+
+    if (battery->level == level)
+        return;
+
+    battery->level = level;
+    sysfs_notify(&battery->hdev->dev.kobj, NULL, "charge_level");
+    razer_battery_changed(battery);
+}
+
+/**
+ * Store the charging status and wake up pollers of "charge_status" if it changed
+ */
+void razer_battery_set_status(struct razer_battery *battery, u8 status)
+{
+    battery->status_updated = jiffies;
+
+    if (battery->status == status)
+        return;
+
+    battery->status = status;
+    sysfs_notify(&battery->hdev->dev.kobj, NULL, "charge_status");
+    razer_battery_changed(battery);
+}
+
+/**
+ * Store the low battery threshold reported through the power_supply device
+ */
+void razer_battery_set_low_threshold(struct razer_battery *battery, u8 threshold)
+{
+    if (battery->low_threshold == threshold)
+        return;
+
+    battery->low_threshold = threshold;
+    razer_battery_changed(battery);
+}
+
+/**
+ * Initialise the state behind the "apply_profile" attribute
+ */
+void razer_profile_init(struct razer_profile_status *status)
+{
+    mutex_init(&status->lock);
+    status->owner = NULL;
+    status->count = 0;
+}
+
+/**
+ * Take the device lock for a transaction
+ *
+ * Skipped when the current task already holds it for an apply_profile write.
+ * Returns whether the lock was taken, which has to be passed to razer_device_unlock().
+ */
+bool razer_device_lock(struct mutex *device_lock, struct razer_profile_status *status)
+{
+    // Only ever equal to current if we set it ourselves
+    if (READ_ONCE(status->owner) == current)
+        return false;
+
+    mutex_lock(device_lock);
+    return true;
+}
+
+/**
+ * Release the device lock taken by razer_device_lock()
+ */
+void razer_device_unlock(struct mutex *device_lock, bool locked)
+{
+    if (locked)
+        mutex_unlock(device_lock);
+}
+
+/**
+ * Take the profile and device locks for a write that spans several attributes
+ *
+ * Stores called until razer_profile_unlock() run without taking the device lock again.
+ */
+void razer_profile_lock(struct razer_profile_status *status, struct mutex *device_lock)
+{
+    mutex_lock(&status->lock);
+    mutex_lock(device_lock);
+    WRITE_ONCE(status->owner, current);
+}
+
+/**
+ * Release the locks taken by razer_profile_lock()
+ */
+void razer_profile_unlock(struct razer_profile_status *status, struct mutex *device_lock)
+{
+    WRITE_ONCE(status->owner, NULL);
+    mutex_unlock(device_lock);
+    mutex_unlock(&status->lock);
+}
+
+/**
+ * Parse the next item of a profile
+ *
+ * Every item is encoded as NAME_LEN NAME VALUE_LEN VALUE where both lengths
+ * are a single byte. Returns the number of bytes consumed, 0 at the end of
+ * the buffer or -EINVAL if the item is truncated.
+ */
+static ssize_t razer_profile_next_item(const char *buf, size_t count, const char **name, size_t *name_len, const char **value, size_t *value_len)
+{
+    size_t offset = 0;
+
+    if (count == 0)
+        return 0;
+
+    *name_len = (u8)buf[offset++];
+    if (*name_len == 0 || offset + *name_len + 1 > count)
+        return -EINVAL;
+
+    *name = &buf[offset];
+    offset += *name_len;
+
+    *value_len = (u8)buf[offset++];
+    if (offset + *value_len > count)
+        return -EINVAL;
+
+    *value = &buf[offset];
+    offset += *value_len;
+
+    return offset;
+}
+
+/**
+ * Check whether an attribute file has been created for this device
+ */
+bool razer_attr_exists(struct device *dev, struct device_attribute *attr)
+{
+    struct kernfs_node *kn;
+
+    kn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+    if (!kn)
+        return false;
+
+    sysfs_put(kn);
+    return true;
+}
+
+/**
+ * Find a settable attribute by name that has been created for this device
+ */
+static struct device_attribute *razer_profile_find_attr(struct device *dev, struct device_attribute *const *attrs, size_t num_attrs, const char *name, size_t name_len)
+{
+    size_t i;
+
+    for (i = 0; i < num_attrs; i++) {
+        if (strlen(attrs[i]->attr.name) != name_len || strncmp(attrs[i]->attr.name, name, name_len) != 0)
+            continue;
+
+        return razer_attr_exists(dev, attrs[i]) ? attrs[i] : NULL;
+    }
+
+    return NULL;
+}
+
+/**
+ * Write a list of attribute values in one go
+ *
+ * The whole profile is validated before anything is sent to the device, so a
+ * typo doesn't leave the device half configured. The device lock is held
+ * over all items, so the profile lands as a whole. Errors reported by the
+ * individual attributes don't abort the profile, they can be read back from
+ * the attribute afterwards.
+ */
+ssize_t razer_profile_apply(struct device *dev, struct device_attribute *const *attrs, size_t num_attrs, struct razer_profile_status *status, struct mutex *device_lock, const char *buf, size_t count)
+{
+    struct device_attribute *attr;
+    const char *name, *value;
+    size_t name_len, value_len;
+    size_t offset = 0;
+    unsigned int items = 0;
+    ssize_t len, ret;
+    char *arg;
+
+    while ((len = razer_profile_next_item(buf + offset, count - offset, &name, &name_len, &value, &value_len)) > 0) {
+        if (!razer_profile_find_attr(dev, attrs, num_attrs, name, name_len)) {
+            dev_warn(dev, "apply_profile: unknown attribute %.*s\n", (int)name_len, name);
+            return -EINVAL;
+        }
+
+        if (++items > RAZER_PROFILE_MAX_ITEMS) {
+            dev_warn(dev, "apply_profile: more than %d items\n", RAZER_PROFILE_MAX_ITEMS);
+            return -E2BIG;
+        }
+
+        offset += len;
+    }
+
+    if (len < 0) {
+        dev_warn(dev, "apply_profile: truncated item at offset %zu\n", offset);
+        return len;
+    }
+
+    razer_profile_lock(status, device_lock);
+    status->count = 0;
+
+    offset = 0;
+    while ((len = razer_profile_next_item(buf + offset, count - offset, &name, &name_len, &value, &value_len)) > 0) {
+        attr = razer_profile_find_attr(dev, attrs, num_attrs, name, name_len);
+        offset += len;
+
+        arg = kmemdup_nul(value, value_len, GFP_KERNEL);
+        if (!arg) {
+            ret = -ENOMEM;
+        } else {
+            ret = attr->store(dev, attr, arg, value_len);
+            kfree(arg);
+        }
+
+        status->items[status->count].name = attr->attr.name;
+        status->items[status->count].err = ret < 0 ? ret : 0;
+        status->count++;
+    }
+
+    razer_profile_unlock(status, device_lock);
+
+    return count;
+}
+
+/**
+ * Print the result of every item of the last applied profile, one per line
+ */
+ssize_t razer_profile_show_status(struct razer_profile_status *status, char *buf)
+{
+    ssize_t len = 0;
+    unsigned int i;
+
+    mutex_lock(&status->lock);
+    for (i = 0; i < status->count; i++)
+        len += scnprintf(buf + len, PAGE_SIZE - len, "%s %d\n", status->items[i].name, status->items[i].err);
+    mutex_unlock(&status->lock);
+
+    return len;
+}
@@ -9,6 +9,8 @@
 
 #include <linux/hid.h>
 #include <linux/usb/input.h>
+#include <linux/workqueue.h>
+#include <linux/power_supply.h>
 #include "compat.h"
 
 #define DRIVER_VERSION "3.12.1"
@@ -145,6 +147,69 @@ struct razer_argb_report {
 };
 static_assert(sizeof(struct razer_argb_report) == 320);
 
+// Interval in which the drivers refresh the battery state of wireless devices
+#define RAZER_BATTERY_REFRESH_MS 60000
+// Reads of the charge attributes within this interval are served from the cache
+#define RAZER_BATTERY_CACHE_MS 10000
+
+/*
+ * Battery state as last read from the device, -1 if unknown
+ *
+ * Whenever a value changes sysfs_notify() is fired on the matching
+ * charge_level / charge_status attribute, so userspace can block in poll()
+ * instead of periodically reading them.
+ *
+ * The same state is exposed through a power_supply device so upower and
+ * friends don't need to talk to the device themselves.
+ */
+struct razer_battery {
+    struct hid_device *hdev;
+    struct delayed_work work;
+    struct power_supply *psy;
+    struct power_supply_desc psy_desc;
+    unsigned long level_updated;
+    unsigned long status_updated;
+    int level;
+    int status;
+    int low_threshold;
+};
+
+/*
+ * Device mode as last set by the driver, cached so the mode switch before a
+ * custom frame doesn't cost an extra transfer every frame. Only read and
+ * written under the device lock. The device forgets its mode over a reset,
+ * so the cache is invalidated on resume. Wireless devices behind a receiver
+ * reconnect without a resume, the cache is invalidated on any failed
+ * transaction instead, which the periodic battery refresh runs into while
+ * the device is away.
+ */
+#define RAZER_DEVICE_MODE_UNKNOWN -1
+#define RAZER_DEVICE_MODE(mode, param) (((mode) << 8) | (param))
+
+// Maximum number of attributes that can be set through one apply_profile write
+#define RAZER_PROFILE_MAX_ITEMS 32
+
+/*
+ * Result of the last apply_profile write.
+ *
+ * The lock is held for a whole profile so two writers can't interleave their
+ * settings. Drivers also hold it for other writes that span several attributes.
+ *
+ * While a profile is applied its task also holds the device lock and is
+ * recorded as owner, the stores then send through razer_device_lock()
+ * without taking the device lock again. That way no other sysfs write can
+ * reach the device between two items of a profile.
+ */
+struct razer_profile_status {
+    struct mutex lock;
+    struct task_struct *owner;
+    unsigned int count;
+    struct {
+        const char *name;
+        int err;
+    } items[RAZER_PROFILE_MAX_ITEMS];
+};
+
 int razer_send_control_msg(struct hid_device *hdev, const void *data, u16 size, u16 index, ulong wait);
 int razer_send_control_msg_old_device(struct hid_device *hdev, const void *data, uint value, uint index, uint size, ulong wait);
 int razer_get_usb_response(struct hid_device *hdev, unsigned int report_index, struct razer_report* request_report, unsigned int response_index, struct razer_report* response_report, unsigned long wait);
@@ -152,6 +217,22 @@ int razer_send_argb_msg(struct hid_device *hdev, unsigned char channel, size_t s
 unsigned char razer_calculate_crc(struct razer_report *report);
 struct razer_report get_razer_report(unsigned char command_class, unsigned char command_id, unsigned char data_size);
 void print_erroneous_report(struct hid_device *hdev, struct razer_report* report, const char *message);
+void razer_battery_init(struct razer_battery *battery, struct hid_device *hdev, work_func_t func);
+int razer_battery_register(struct razer_battery *battery);
+void razer_battery_stop(struct razer_battery *battery);
+bool razer_battery_get_cached_level(struct razer_battery *battery, u8 *level);
+bool razer_battery_get_cached_status(struct razer_battery *battery, u8 *status);
+void razer_battery_set_level(struct razer_battery *battery, u8 level);
+void razer_battery_set_status(struct razer_battery *battery, u8 status);
+void razer_battery_set_low_threshold(struct razer_battery *battery, u8 threshold);
+bool razer_attr_exists(struct device *dev, struct device_attribute *attr);
+void razer_profile_init(struct razer_profile_status *status);
+bool razer_device_lock(struct mutex *device_lock, struct razer_profile_status *status);
+void razer_device_unlock(struct mutex *device_lock, bool locked);
+void razer_profile_lock(struct razer_profile_status *status, struct mutex *device_lock);
+void razer_profile_unlock(struct razer_profile_status *status, struct mutex *device_lock);
+ssize_t razer_profile_apply(struct device *dev, struct device_attribute *const *attrs, size_t num_attrs, struct razer_profile_status *status, struct mutex *device_lock, const char *buf, size_t count);
+ssize_t razer_profile_show_status(struct razer_profile_status *status, char *buf);
 
 /* Borrowed from drivers/hid/usbhid/usbhid.h */
 #define	hid_to_usb_dev(hid_dev) \
@@ -418,38 +418,49 @@ static int __must_check razer_send_payload_no_response(struct razer_kbd_device *
 
 /**
  * Function to send to device, get response, and actually check the response
+ *
+ * If mode isn't RAZER_DEVICE_MODE_UNKNOWN the request puts the device into
+ * that mode. The device mode cache is checked and updated under the device
+ * lock of the attempt that sends it, so the cache can't end up disagreeing
+ * with the device. With skip_cached nothing is sent if the cache already
+ * has the mode.
  */
-static int __must_check razer_send_payload(struct razer_kbd_device *device, struct razer_report *request, struct razer_report *response)
+static int __must_check razer_send_payload_mode(struct razer_kbd_device *device, struct razer_report *request, struct razer_report *response, int mode, bool skip_cached)
 {
+    bool locked;
     int retry;
     int err;
 
     request->crc = razer_calculate_crc(request);
 
     for (retry = 5; retry > 0; retry--) {
-        mutex_lock(&device->lock);
+        locked = razer_device_lock(&device->lock, &device->profile);
+
+        if (skip_cached && device->device_mode == mode) {
+            razer_device_unlock(&device->lock, locked);
+            return 0;
+        }
+
         err = razer_get_report(device->hdev, request, response);
-        mutex_unlock(&device->lock);
         if (err) {
             print_erroneous_report(device->hdev, response, "Invalid Report Length");
-            goto retry;
-        }
-
-        /* Check the packet number, class and command are the same */
-        if (response->remaining_packets != request->remaining_packets ||
-            response->command_class != request->command_class ||
-            response->command_id.id != request->command_id.id) {
+        } else if (response->remaining_packets != request->remaining_packets ||
+                   response->command_class != request->command_class ||
+                   response->command_id.id != request->command_id.id) {
+            /* Check the packet number, class and command are the same */
             print_erroneous_report(device->hdev, response, "Response doesn't match request");
             err = -EINVAL;
-            goto retry;
+        } else if (response->status == RAZER_CMD_SUCCESSFUL ||
+                   response->status == RAZER_CMD_BUSY) {
+            /* Some commands respond with 'busy' but succeed. Treat it as success. */
+            if (mode != RAZER_DEVICE_MODE_UNKNOWN)
+                device->device_mode = mode;
+            razer_device_unlock(&device->lock, locked);
+            return 0;
         }
 
-        /* Some commands respond with 'busy' but succeed. Treat it as success. */
-        if (response->status == RAZER_CMD_SUCCESSFUL ||
-            response->status == RAZER_CMD_BUSY)
-            return 0;
+        razer_device_unlock(&device->lock, locked);
 
-retry:
         hid_dbg(device->hdev,
                 "Sending command failed: %d, response status: %d, retries left: %d\n",
                 err, response->status, retry);
@@ -458,6 +469,11 @@ retry:
         fsleep(10000);
     }
 
+    // A wireless device that dropped off its receiver fails here and comes back in its default mode
+    locked = razer_device_lock(&device->lock, &device->profile);
+    device->device_mode = RAZER_DEVICE_MODE_UNKNOWN;
+    razer_device_unlock(&device->lock, locked);
+
     if (err)
         return err;
 
@@ -479,6 +495,14 @@ retry:
     }
 }
 
+/**
+ * Function to send to device, get response, and actually check the response
+ */
+static int __must_check razer_send_payload(struct razer_kbd_device *device, struct razer_report *request, struct razer_report *response)
+{
+    return razer_send_payload_mode(device, request, response, RAZER_DEVICE_MODE_UNKNOWN, false);
+}
+
 /**
  * Reads the physical layout of the keyboard.
  *
@@ -652,17 +676,17 @@ static int razer_set_device_mode(struct razer_kbd_device *device, unsigned char
         return -EINVAL;
     }
 
-    return razer_send_payload(device, &request, &response);
+    // Skip the transfer if the device is already in the requested mode
+    return razer_send_payload_mode(device, &request, &response, RAZER_DEVICE_MODE(mode, param), true);
 }
 
 /**
- * Read device file "charge_level"
+ * Get the battery level (0-255) from the device
  *
- * Returns an integer which needs to be scaled from 0-255 -> 0-100
+ * Returns -EOPNOTSUPP if the device has no battery
  */
-static ssize_t razer_attr_read_charge_level(struct device *dev, struct device_attribute *attr, char *buf)
+static int razer_get_charge_level(struct razer_kbd_device *device, unsigned char *level)
 {
-    struct razer_kbd_device *device = dev_get_drvdata(dev);
     struct razer_report request = {0};
     struct razer_report response = {0};
     int err;
@@ -692,25 +716,51 @@ static ssize_t razer_attr_read_charge_level(struct device *dev, struct device_at
         break;
 
     default:
-        dev_warn(dev, "razerkbd: charge_level not supported for this model\n");
-        return -EINVAL;
+        return -EOPNOTSUPP;
     }
 
+    if (razer_battery_get_cached_level(&device->battery, level))
+        return 0;
+
     err = razer_send_payload(device, &request, &response);
     if (err)
         return err;
 
-    return sysfs_emit(buf, "%d\n", response.arguments[1]);
+    *level = response.arguments[1];
+    razer_battery_set_level(&device->battery, *level);
+
+    return 0;
 }
 
 /**
- * Read device file "charge_status"
+ * Read device file "charge_level"
  *
- * Returns 0 when not charging, 1 when charging
+ * Returns an integer which needs to be scaled from 0-255 -> 0-100
  */
-static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_attribute *attr, char *buf)
+static ssize_t razer_attr_read_charge_level(struct device *dev, struct device_attribute *attr, char *buf)
 {
     struct razer_kbd_device *device = dev_get_drvdata(dev);
+    unsigned char level;
+    int err;
+
+    err = razer_get_charge_level(device, &level);
+    if (err == -EOPNOTSUPP) {
+        dev_warn(dev, "razerkbd: charge_level not supported for this model\n");
+        return -EINVAL;
+    }
+    if (err)
+        return err;
+
+    return sysfs_emit(buf, "%d\n", level);
+}
+
+/**
+ * Get the charging status from the device
+ *
+ * Returns -EOPNOTSUPP if the device has no battery
+ */
+static int razer_get_charge_status(struct razer_kbd_device *device, unsigned char *status)
+{
     struct razer_report request = {0};
     struct razer_report response = {0};
     int err;
@@ -740,15 +790,42 @@ static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_a
         break;
 
     default:
-        dev_warn(dev, "razerkbd: charge_status not supported for this model\n");
-        return -EINVAL;
+        return -EOPNOTSUPP;
     }
 
+    if (razer_battery_get_cached_status(&device->battery, status))
+        return 0;
+
     err = razer_send_payload(device, &request, &response);
     if (err)
         return err;
 
-    return sysfs_emit(buf, "%d\n", response.arguments[1]);
+    *status = response.arguments[1];
+    razer_battery_set_status(&device->battery, *status);
+
+    return 0;
+}
+
+/**
+ * Read device file "charge_status"
+ *
+ * Returns 0 when not charging, 1 when charging
+ */
+static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+    unsigned char status;
+    int err;
+
+    err = razer_get_charge_status(device, &status);
+    if (err == -EOPNOTSUPP) {
+        dev_warn(dev, "razerkbd: charge_status not supported for this model\n");
+        return -EINVAL;
+    }
+    if (err)
+        return err;
+
+    return sysfs_emit(buf, "%d\n", status);
 }
 
 /**
@@ -812,15 +889,25 @@ static ssize_t razer_attr_write_charge_colour(struct device *dev, struct device_
 }
 
 /**
- * Read device file "charge_low_threshold"
+ * Get the low battery threshold (0-255) from the device
+ *
+ * Returns -EOPNOTSUPP if the device has no configurable threshold
  */
-static ssize_t razer_attr_read_charge_low_threshold(struct device *dev, struct device_attribute *attr, char *buf)
+static int razer_get_charge_low_threshold(struct razer_kbd_device *device, unsigned char *threshold)
 {
-    struct razer_kbd_device *device = dev_get_drvdata(dev);
     struct razer_report request = {0};
     struct razer_report response = {0};
     int err;
 
+    switch (device->usb_pid) {
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRED:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRELESS:
+        break;
+
+    default:
+        return -EOPNOTSUPP;
+    }
+
     request = razer_chroma_misc_get_low_battery_threshold();
     request.transaction_id.id = 0xFF;
 
@@ -828,7 +915,30 @@ static ssize_t razer_attr_read_charge_low_threshold(struct device *dev, struct d
     if (err)
         return err;
 
-    return sysfs_emit(buf, "%d\n", response.arguments[0]);
+    *threshold = response.arguments[0];
+    razer_battery_set_low_threshold(&device->battery, *threshold);
+
+    return 0;
+}
+
+/**
+ * Read device file "charge_low_threshold"
+ */
+static ssize_t razer_attr_read_charge_low_threshold(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+    unsigned char threshold;
+    int err;
+
+    err = razer_get_charge_low_threshold(device, &threshold);
+    if (err == -EOPNOTSUPP) {
+        dev_warn(dev, "razerkbd: charge_low_threshold not supported for this model\n");
+        return -EINVAL;
+    }
+    if (err)
+        return err;
+
+    return sysfs_emit(buf, "%d\n", threshold);
 }
 
 /**
@@ -854,6 +964,9 @@ static ssize_t razer_attr_write_charge_low_threshold(struct device *dev, struct
     err = razer_send_payload(device, &request, &response);
     if (err)
         return err;
+
+    razer_battery_set_low_threshold(&device->battery, threshold);
+
     return count;
 }
 
@@ -4307,7 +4420,7 @@ static ssize_t razer_attr_write_device_mode(struct device *dev, struct device_at
     request = razer_chroma_standard_set_device_mode(buf[0], buf[1]);
     request.transaction_id.id = 0xFF;
 
-    err = razer_send_payload(device, &request, &response);
+    err = razer_send_payload_mode(device, &request, &response, RAZER_DEVICE_MODE(buf[0], buf[1]), false);
     if (err)
         return err;
 
@@ -4783,6 +4896,65 @@ static DEVICE_ATTR(charge_effect,           0220, NULL,
 static DEVICE_ATTR(charge_colour,           0220, NULL,                                       razer_attr_write_charge_colour);
 static DEVICE_ATTR(charge_low_threshold,    0660, razer_attr_read_charge_low_threshold,       razer_attr_write_charge_low_threshold);
 
+/*
+ * Attributes that can be set through apply_profile
+ */
+static struct device_attribute *const razer_profile_attrs[] = {
+    &dev_attr_game_led_state,
+    &dev_attr_macro_led_state,
+    &dev_attr_macro_led_effect,
+    &dev_attr_logo_led_state,
+    &dev_attr_profile_led_red,
+    &dev_attr_profile_led_green,
+    &dev_attr_profile_led_blue,
+    &dev_attr_fn_toggle,
+    &dev_attr_poll_rate,
+    &dev_attr_keyswitch_optimization,
+    &dev_attr_matrix_effect_none,
+    &dev_attr_matrix_effect_wave,
+    &dev_attr_matrix_effect_wheel,
+    &dev_attr_matrix_effect_spectrum,
+    &dev_attr_matrix_effect_reactive,
+    &dev_attr_matrix_effect_static,
+    &dev_attr_matrix_effect_starlight,
+    &dev_attr_matrix_effect_breath,
+    &dev_attr_matrix_effect_pulsate,
+    &dev_attr_matrix_brightness,
+    &dev_attr_matrix_effect_custom,
+    &dev_attr_key_super,
+    &dev_attr_key_alt_tab,
+    &dev_attr_key_alt_f4,
+    &dev_attr_charge_effect,
+    &dev_attr_charge_colour,
+    &dev_attr_charge_low_threshold,
+};
+
+/**
+ * Read device file "apply_profile"
+ *
+ * Returns one "name error" line per item of the last applied profile
+ */
+static ssize_t razer_attr_read_apply_profile(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+
+    return razer_profile_show_status(&device->profile, buf);
+}
+
+/**
+ * Write device file "apply_profile"
+ *
+ * Sets several attributes at once, each item is NAME_LEN NAME VALUE_LEN VALUE
+ */
+static ssize_t razer_attr_write_apply_profile(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+
+    return razer_profile_apply(dev, razer_profile_attrs, ARRAY_SIZE(razer_profile_attrs), &device->profile, &device->lock, buf, count);
+}
+
+static DEVICE_ATTR(apply_profile, 0660, razer_attr_read_apply_profile, razer_attr_write_apply_profile);
+
 /**
  * Deal with FN toggle
  */
@@ -5255,6 +5427,28 @@ static int razer_kbd_input_mapping(struct hid_device *hdev, struct hid_input *hi
     }
 }
 
+/**
+ * Periodically refresh the battery state and register the power supply,
+ * stops for devices without battery
+ */
+static void razer_kbd_battery_work(struct work_struct *work)
+{
+    struct razer_kbd_device *dev = container_of(to_delayed_work(work), struct razer_kbd_device, battery.work);
+    unsigned char level, status, threshold;
+
+    if (razer_get_charge_level(dev, &level) == -EOPNOTSUPP)
+        return;
+
+    razer_get_charge_status(dev, &status);
+
+    if (dev->battery.low_threshold < 0)
+        razer_get_charge_low_threshold(dev, &threshold);
+
+    razer_battery_register(&dev->battery);
+
+    schedule_delayed_work(&dev->battery.work, msecs_to_jiffies(RAZER_BATTERY_REFRESH_MS));
+}
+
 static void razer_kbd_init(struct razer_kbd_device *dev, struct hid_device *hdev)
 {
     struct usb_interface *intf = to_usb_interface(hdev->dev.parent);
@@ -5267,6 +5461,11 @@ static void razer_kbd_init(struct razer_kbd_device *dev, struct hid_device *hdev
     dev->usb_vid = usb_dev->descriptor.idVendor;
     dev->usb_pid = usb_dev->descriptor.idProduct;
     dev->usb_interface_protocol = intf->cur_altsetting->desc.bInterfaceProtocol;
+
+    dev->device_mode = RAZER_DEVICE_MODE_UNKNOWN;
+
+    razer_battery_init(&dev->battery, hdev, razer_kbd_battery_work);
+    razer_profile_init(&dev->profile);
 }
 
 /**
@@ -5311,6 +5510,7 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_type);                           // Get string of device type
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_mode);                           // Get device mode
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_kbd_layout);                            // Gets the physical layout
+        CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_apply_profile);                         // Sets several attributes at once
 
         switch(usb_dev->descriptor.idProduct) {
 
@@ -5827,6 +6027,10 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
         usb_disable_autosuspend(usb_dev);
     }
 
+    if(intf->cur_altsetting->desc.bInterfaceProtocol == USB_INTERFACE_PROTOCOL_MOUSE) {
+        schedule_delayed_work(&dev->battery.work, 0);
+    }
+
     //razer_activate_macro_keys(usb_dev);
     //msleep(3000);
     return 0;
@@ -5858,6 +6062,7 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
         device_remove_file(&hdev->dev, &dev_attr_device_type);                           // Get string of device type
         device_remove_file(&hdev->dev, &dev_attr_device_mode);                           // Get device mode
         device_remove_file(&hdev->dev, &dev_attr_kbd_layout);                            // Gets the physical layout
+        device_remove_file(&hdev->dev, &dev_attr_apply_profile);                         // Sets several attributes at once
 
         switch(usb_dev->descriptor.idProduct) {
 
@@ -6347,6 +6552,7 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
         device_remove_file(&hdev->dev, &dev_attr_key_alt_f4);
     }
 
+    razer_battery_stop(&dev->battery);
     hid_hw_stop(hdev);
     kfree(dev);
     hid_info(hdev, "Razer Device disconnected\n");
@@ -6375,6 +6581,24 @@ static int razer_input_configured(struct hid_device *hdev, struct hid_input *hi)
     return 0;
 }
 
+#ifdef CONFIG_PM
+/**
+ * Forget the cached device mode, the device might have been reset while suspended
+ */
+static int razer_kbd_resume(struct hid_device *hdev)
+{
+    struct razer_kbd_device *device = hid_get_drvdata(hdev);
+
+    if (device) {
+        mutex_lock(&device->lock);
+        device->device_mode = RAZER_DEVICE_MODE_UNKNOWN;
+        mutex_unlock(&device->lock);
+    }
+
+    return 0;
+}
+#endif
+
 /**
  * Device ID mapping table
  */
@@ -6515,6 +6739,10 @@ static struct hid_driver razer_kbd_driver = {
     .event = razer_event,
     .raw_event = razer_raw_event,
     .input_configured = razer_input_configured,
+#ifdef CONFIG_PM
+    .resume = razer_kbd_resume,
+    .reset_resume = razer_kbd_resume,
+#endif
 };
 
 module_hid_driver(razer_kbd_driver);
@@ -115,15 +115,16 @@ static int razer_get_report(struct hid_device *hdev, struct razer_report *reques
  */
 static int __must_check razer_send_payload(struct razer_mouse_device *device, struct razer_report *request, struct razer_report *response)
 {
+    bool locked;
     int retry;
     int err;
 
     request->crc = razer_calculate_crc(request);
 
     for (retry = 5; retry > 0; retry--) {
-        mutex_lock(&device->lock);
+        locked = razer_device_lock(&device->lock, &device->profile);
         err = razer_get_report(device->hdev, request, response);
-        mutex_unlock(&device->lock);
+        razer_device_unlock(&device->lock, locked);
         if (err) {
             print_erroneous_report(device->hdev, response, "Invalid Report Length");
             goto retry;
@@ -179,6 +180,8 @@ retry:
  */
 static int deathadder3_5g_set_led_state(struct razer_mouse_device *device, unsigned char led_id, bool enabled)
 {
+    bool locked;
+
     switch (led_id) {
     case SCROLL_WHEEL_LED:
         if (enabled) {
@@ -201,15 +204,17 @@ static int deathadder3_5g_set_led_state(struct razer_mouse_device *device, unsig
         return -EINVAL;
     }
 
-    mutex_lock(&device->lock);
+    locked = razer_device_lock(&device->lock, &device->profile);
     razer_send_control_msg_old_device(device->hdev, &device->da3_5g, 0x10, 0x00, sizeof(device->da3_5g), 3000);
-    mutex_unlock(&device->lock);
+    razer_device_unlock(&device->lock, locked);
 
     return 0;
 }
 
 static void deathadder3_5g_set_poll_rate(struct razer_mouse_device *device, unsigned short poll_rate)
 {
+    bool locked;
+
     switch(poll_rate) {
     case 1000:
         device->da3_5g.poll = 1;
@@ -225,13 +230,15 @@ static void deathadder3_5g_set_poll_rate(struct razer_mouse_device *device, unsi
         break;
     }
 
-    mutex_lock(&device->lock);
+    locked = razer_device_lock(&device->lock, &device->profile);
     razer_send_control_msg_old_device(device->hdev, &device->da3_5g, 0x10, 0x00, sizeof(device->da3_5g), 3000);
-    mutex_unlock(&device->lock);
+    razer_device_unlock(&device->lock, locked);
 }
 
 static void deathadder3_5g_set_dpi(struct razer_mouse_device *device, unsigned short dpi)
 {
+    bool locked;
+
     switch(dpi) {
     case 450:
         device->da3_5g.dpi = 4;
@@ -248,9 +255,9 @@ static void deathadder3_5g_set_dpi(struct razer_mouse_device *device, unsigned s
         break;
     }
 
-    mutex_lock(&device->lock);
+    locked = razer_device_lock(&device->lock, &device->profile);
     razer_send_control_msg_old_device(device->hdev, &device->da3_5g, 0x10, 0x00, sizeof(device->da3_5g), 3000);
-    mutex_unlock(&device->lock);
+    razer_device_unlock(&device->lock, locked);
 }
 
 static int orochi_2011_set_led_state(struct razer_mouse_device *device, unsigned char led_id, bool enabled)
@@ -1525,13 +1532,12 @@ static ssize_t razer_attr_read_device_serial(struct device *dev, struct device_a
 }
 
 /**
- * Read device file "get_battery"
+ * Get the battery level (0-255) from the device
  *
- * Returns an integer which needs to be scaled from 0-255 -> 0-100
+ * Returns -EOPNOTSUPP if the device has no battery
  */
-static ssize_t razer_attr_read_charge_level(struct device *dev, struct device_attribute *attr, char *buf)
+static int razer_get_charge_level(struct razer_mouse_device *device, unsigned char *level)
 {
-    struct razer_mouse_device *device = dev_get_drvdata(dev);
     struct razer_report request = {0};
     struct razer_report response = {0};
     int err;
@@ -1614,25 +1620,51 @@ static ssize_t razer_attr_read_charge_level(struct device *dev, struct device_at
         break;
 
     default:
-        dev_warn(dev, "razermouse: charge_level not supported for this model\n");
-        return -EINVAL;
+        return -EOPNOTSUPP;
     }
 
+    if (razer_battery_get_cached_level(&device->battery, level))
+        return 0;
+
     err = razer_send_payload(device, &request, &response);
     if (err)
         return err;
 
-    return sysfs_emit(buf, "%d\n", response.arguments[1]);
+    *level = response.arguments[1];
+    razer_battery_set_level(&device->battery, *level);
+
+    return 0;
 }
 
 /**
- * Read device file "is_charging"
+ * Read device file "get_battery"
  *
- * Returns 0 when not charging, 1 when charging
+ * Returns an integer which needs to be scaled from 0-255 -> 0-100
  */
-static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_attribute *attr, char *buf)
+static ssize_t razer_attr_read_charge_level(struct device *dev, struct device_attribute *attr, char *buf)
 {
     struct razer_mouse_device *device = dev_get_drvdata(dev);
+    unsigned char level;
+    int err;
+
+    err = razer_get_charge_level(device, &level);
+    if (err == -EOPNOTSUPP) {
+        dev_warn(dev, "razermouse: charge_level not supported for this model\n");
+        return -EINVAL;
+    }
+    if (err)
+        return err;
+
+    return sysfs_emit(buf, "%d\n", level);
+}
+
+/**
+ * Get the charging status from the device
+ *
+ * Returns -EOPNOTSUPP if the device has no battery
+ */
+static int razer_get_charge_status(struct razer_mouse_device *device, unsigned char *status)
+{
     struct razer_report request = {0};
     struct razer_report response = {0};
     int err;
@@ -1652,7 +1684,9 @@ static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_a
     case USB_DEVICE_ID_RAZER_BASILISK_V3_X_HYPERSPEED:
     case USB_DEVICE_ID_RAZER_BASILISK_MOBILE_RECEIVER:
     case USB_DEVICE_ID_RAZER_BASILISK_MOBILE_WIRED:
-        return sysfs_emit(buf, "0\n");
+        *status = 0;
+        razer_battery_set_status(&device->battery, *status);
+        return 0;
         break;
 
     case USB_DEVICE_ID_RAZER_LANCEHEAD_WIRED:
@@ -1719,15 +1753,42 @@ static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_a
         break;
 
     default:
-        dev_warn(dev, "razermouse: charge_status not supported for this model\n");
-        return -EINVAL;
+        return -EOPNOTSUPP;
     }
 
+    if (razer_battery_get_cached_status(&device->battery, status))
+        return 0;
+
     err = razer_send_payload(device, &request, &response);
     if (err)
         return err;
 
-    return sysfs_emit(buf, "%d\n", response.arguments[1]);
+    *status = response.arguments[1];
+    razer_battery_set_status(&device->battery, *status);
+
+    return 0;
+}
+
+/**
+ * Read device file "is_charging"
+ *
+ * Returns 0 when not charging, 1 when charging
+ */
+static ssize_t razer_attr_read_charge_status(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_mouse_device *device = dev_get_drvdata(dev);
+    unsigned char status;
+    int err;
+
+    err = razer_get_charge_status(device, &status);
+    if (err == -EOPNOTSUPP) {
+        dev_warn(dev, "razermouse: charge_status not supported for this model\n");
+        return -EINVAL;
+    }
+    if (err)
+        return err;
+
+    return sysfs_emit(buf, "%d\n", status);
 }
 
 /**
@@ -3508,11 +3569,12 @@ static ssize_t razer_attr_write_device_idle_time(struct device *dev, struct devi
 }
 
 /**
- * Read device file "charge_low_threshold"
+ * Get the low battery threshold (0-255) from the device
+ *
+ * Returns -EOPNOTSUPP if the device has no battery
  */
-static ssize_t razer_attr_read_charge_low_threshold(struct device *dev, struct device_attribute *attr, char *buf)
+static int razer_get_charge_low_threshold(struct razer_mouse_device *device, unsigned char *threshold)
 {
-    struct razer_mouse_device *device = dev_get_drvdata(dev);
     struct razer_report request = {0};
     struct razer_report response = {0};
     int err;
@@ -3592,15 +3654,37 @@ static ssize_t razer_attr_read_charge_low_threshold(struct device *dev, struct d
         break;
 
     default:
-        dev_warn(dev, "razermouse: charge_low_threshold not supported for this model\n");
-        return -EINVAL;
+        return -EOPNOTSUPP;
     }
 
     err = razer_send_payload(device, &request, &response);
     if (err)
         return err;
 
-    return sysfs_emit(buf, "%d\n", response.arguments[0]);
+    *threshold = response.arguments[0];
+    razer_battery_set_low_threshold(&device->battery, *threshold);
+
+    return 0;
+}
+
+/**
+ * Read device file "charge_low_threshold"
+ */
+static ssize_t razer_attr_read_charge_low_threshold(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_mouse_device *device = dev_get_drvdata(dev);
+    unsigned char threshold;
+    int err;
+
+    err = razer_get_charge_low_threshold(device, &threshold);
+    if (err == -EOPNOTSUPP) {
+        dev_warn(dev, "razermouse: charge_low_threshold not supported for this model\n");
+        return -EINVAL;
+    }
+    if (err)
+        return err;
+
+    return sysfs_emit(buf, "%d\n", threshold);
 }
 
 /**
@@ -3703,6 +3787,8 @@ static ssize_t razer_attr_write_charge_low_threshold(struct device *dev, struct
     if (err)
         return err;
 
+    razer_battery_set_low_threshold(&device->battery, threshold);
+
     return count;
 }
 
@@ -5854,6 +5940,220 @@ static DEVICE_ATTR(hyperpolling_wireless_dongle_indicator_led_mode,
 static DEVICE_ATTR(hyperpolling_wireless_dongle_pair,                           0220, NULL, razer_attr_write_hyperpolling_wireless_dongle_pair);
 static DEVICE_ATTR(hyperpolling_wireless_dongle_unpair,                         0220, NULL, razer_attr_write_hyperpolling_wireless_dongle_unpair);
 
+/*
+ * Attributes that can be set through apply_profile
+ */
+static struct device_attribute *const razer_profile_attrs[] = {
+    &dev_attr_poll_rate,
+    &dev_attr_dpi,
+    &dev_attr_dpi_stages,
+    &dev_attr_device_idle_time,
+    &dev_attr_scroll_mode,
+    &dev_attr_scroll_acceleration,
+    &dev_attr_scroll_smart_reel,
+    &dev_attr_tilt_hwheel,
+    &dev_attr_tilt_repeat,
+    &dev_attr_tilt_repeat_delay,
+    &dev_attr_charge_effect,
+    &dev_attr_charge_colour,
+    &dev_attr_charge_low_threshold,
+    &dev_attr_matrix_brightness,
+    &dev_attr_matrix_effect_none,
+    &dev_attr_matrix_effect_custom,
+    &dev_attr_matrix_effect_static,
+    &dev_attr_matrix_effect_wave,
+    &dev_attr_matrix_effect_spectrum,
+    &dev_attr_matrix_effect_reactive,
+    &dev_attr_matrix_effect_breath,
+    &dev_attr_scroll_led_brightness,
+    &dev_attr_scroll_matrix_effect_wave,
+    &dev_attr_scroll_matrix_effect_spectrum,
+    &dev_attr_scroll_matrix_effect_reactive,
+    &dev_attr_scroll_matrix_effect_breath,
+    &dev_attr_scroll_matrix_effect_static,
+    &dev_attr_scroll_matrix_effect_blinking,
+    &dev_attr_scroll_matrix_effect_none,
+    &dev_attr_scroll_matrix_effect_on,
+    &dev_attr_logo_led_brightness,
+    &dev_attr_logo_matrix_effect_wave,
+    &dev_attr_logo_matrix_effect_spectrum,
+    &dev_attr_logo_matrix_effect_reactive,
+    &dev_attr_logo_matrix_effect_breath,
+    &dev_attr_logo_matrix_effect_static,
+    &dev_attr_logo_matrix_effect_blinking,
+    &dev_attr_logo_matrix_effect_none,
+    &dev_attr_logo_matrix_effect_on,
+    &dev_attr_left_led_brightness,
+    &dev_attr_left_matrix_effect_wave,
+    &dev_attr_left_matrix_effect_spectrum,
+    &dev_attr_left_matrix_effect_reactive,
+    &dev_attr_left_matrix_effect_breath,
+    &dev_attr_left_matrix_effect_static,
+    &dev_attr_left_matrix_effect_none,
+    &dev_attr_right_led_brightness,
+    &dev_attr_right_matrix_effect_wave,
+    &dev_attr_right_matrix_effect_spectrum,
+    &dev_attr_right_matrix_effect_reactive,
+    &dev_attr_right_matrix_effect_breath,
+    &dev_attr_right_matrix_effect_static,
+    &dev_attr_right_matrix_effect_none,
+    &dev_attr_backlight_led_brightness,
+    &dev_attr_backlight_matrix_effect_wave,
+    &dev_attr_backlight_matrix_effect_spectrum,
+    &dev_attr_backlight_matrix_effect_reactive,
+    &dev_attr_backlight_matrix_effect_breath,
+    &dev_attr_backlight_matrix_effect_static,
+    &dev_attr_backlight_matrix_effect_none,
+    &dev_attr_backlight_matrix_effect_on,
+    &dev_attr_hyperpolling_wireless_dongle_indicator_led_mode,
+};
+
+/**
+ * Read device file "apply_profile"
+ *
+ * Returns one "name error" line per item of the last applied profile
+ */
+static ssize_t razer_attr_read_apply_profile(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_mouse_device *device = dev_get_drvdata(dev);
+
+    return razer_profile_show_status(&device->profile, buf);
+}
+
+/**
+ * Write device file "apply_profile"
+ *
+ * Sets several attributes at once, each item is NAME_LEN NAME VALUE_LEN VALUE
+ */
+static ssize_t razer_attr_write_apply_profile(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_mouse_device *device = dev_get_drvdata(dev);
+
+    return razer_profile_apply(dev, razer_profile_attrs, ARRAY_SIZE(razer_profile_attrs), &device->profile, &device->lock, buf, count);
+}
+
+static DEVICE_ATTR(apply_profile, 0660, razer_attr_read_apply_profile, razer_attr_write_apply_profile);
+
+/*
+ * Per zone attributes used by "zone_matrix_effect"
+ */
+static struct device_attribute *const razer_zone_effect_attrs[RAZER_ZONE_COUNT][RAZER_ZONE_EFFECT_COUNT] = {
+    [RAZER_ZONE_LOGO] = {
+        [RAZER_ZONE_EFFECT_NONE] = &dev_attr_logo_matrix_effect_none,
+        [RAZER_ZONE_EFFECT_STATIC] = &dev_attr_logo_matrix_effect_static,
+        [RAZER_ZONE_EFFECT_SPECTRUM] = &dev_attr_logo_matrix_effect_spectrum,
+        [RAZER_ZONE_EFFECT_BREATH] = &dev_attr_logo_matrix_effect_breath,
+        [RAZER_ZONE_EFFECT_WAVE] = &dev_attr_logo_matrix_effect_wave,
+        [RAZER_ZONE_EFFECT_REACTIVE] = &dev_attr_logo_matrix_effect_reactive,
+        [RAZER_ZONE_EFFECT_BLINKING] = &dev_attr_logo_matrix_effect_blinking,
+        [RAZER_ZONE_EFFECT_ON] = &dev_attr_logo_matrix_effect_on,
+        [RAZER_ZONE_EFFECT_BRIGHTNESS] = &dev_attr_logo_led_brightness,
+    },
+    [RAZER_ZONE_SCROLL] = {
+        [RAZER_ZONE_EFFECT_NONE] = &dev_attr_scroll_matrix_effect_none,
+        [RAZER_ZONE_EFFECT_STATIC] = &dev_attr_scroll_matrix_effect_static,
+        [RAZER_ZONE_EFFECT_SPECTRUM] = &dev_attr_scroll_matrix_effect_spectrum,
+        [RAZER_ZONE_EFFECT_BREATH] = &dev_attr_scroll_matrix_effect_breath,
+        [RAZER_ZONE_EFFECT_WAVE] = &dev_attr_scroll_matrix_effect_wave,
+        [RAZER_ZONE_EFFECT_REACTIVE] = &dev_attr_scroll_matrix_effect_reactive,
+        [RAZER_ZONE_EFFECT_BLINKING] = &dev_attr_scroll_matrix_effect_blinking,
+        [RAZER_ZONE_EFFECT_ON] = &dev_attr_scroll_matrix_effect_on,
+        [RAZER_ZONE_EFFECT_BRIGHTNESS] = &dev_attr_scroll_led_brightness,
+    },
+    [RAZER_ZONE_LEFT] = {
+        [RAZER_ZONE_EFFECT_NONE] = &dev_attr_left_matrix_effect_none,
+        [RAZER_ZONE_EFFECT_STATIC] = &dev_attr_left_matrix_effect_static,
+        [RAZER_ZONE_EFFECT_SPECTRUM] = &dev_attr_left_matrix_effect_spectrum,
+        [RAZER_ZONE_EFFECT_BREATH] = &dev_attr_left_matrix_effect_breath,
+        [RAZER_ZONE_EFFECT_WAVE] = &dev_attr_left_matrix_effect_wave,
+        [RAZER_ZONE_EFFECT_REACTIVE] = &dev_attr_left_matrix_effect_reactive,
+        [RAZER_ZONE_EFFECT_BRIGHTNESS] = &dev_attr_left_led_brightness,
+    },
+    [RAZER_ZONE_RIGHT] = {
+        [RAZER_ZONE_EFFECT_NONE] = &dev_attr_right_matrix_effect_none,
+        [RAZER_ZONE_EFFECT_STATIC] = &dev_attr_right_matrix_effect_static,
+        [RAZER_ZONE_EFFECT_SPECTRUM] = &dev_attr_right_matrix_effect_spectrum,
+        [RAZER_ZONE_EFFECT_BREATH] = &dev_attr_right_matrix_effect_breath,
+        [RAZER_ZONE_EFFECT_WAVE] = &dev_attr_right_matrix_effect_wave,
+        [RAZER_ZONE_EFFECT_REACTIVE] = &dev_attr_right_matrix_effect_reactive,
+        [RAZER_ZONE_EFFECT_BRIGHTNESS] = &dev_attr_right_led_brightness,
+    },
+    [RAZER_ZONE_BACKLIGHT] = {
+        [RAZER_ZONE_EFFECT_NONE] = &dev_attr_backlight_matrix_effect_none,
+        [RAZER_ZONE_EFFECT_STATIC] = &dev_attr_backlight_matrix_effect_static,
+        [RAZER_ZONE_EFFECT_SPECTRUM] = &dev_attr_backlight_matrix_effect_spectrum,
+        [RAZER_ZONE_EFFECT_BREATH] = &dev_attr_backlight_matrix_effect_breath,
+        [RAZER_ZONE_EFFECT_WAVE] = &dev_attr_backlight_matrix_effect_wave,
+        [RAZER_ZONE_EFFECT_REACTIVE] = &dev_attr_backlight_matrix_effect_reactive,
+        [RAZER_ZONE_EFFECT_ON] = &dev_attr_backlight_matrix_effect_on,
+        [RAZER_ZONE_EFFECT_BRIGHTNESS] = &dev_attr_backlight_led_brightness,
+    },
+};
+
+/**
+ * Write device file "zone_matrix_effect"
+ *
+ * Applies the same effect to several zones at once
+ *
+ * Format
+ * ZONE_MASK EFFECT ARGS...
+ *
+ * ARGS are passed on as-is to the matching <zone>_matrix_effect_* or
+ * <zone>_led_brightness attribute of every zone set in ZONE_MASK.
+ */
+static ssize_t razer_attr_write_zone_matrix_effect(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_mouse_device *device = dev_get_drvdata(dev);
+    struct device_attribute *zone_attr;
+    unsigned char zone_mask, effect;
+    unsigned int zone;
+    ssize_t ret = 0;
+
+    if (count < 2) {
+        dev_warn(dev, "razermouse: Zone effect needs a zone mask and an effect\n");
+        return -EINVAL;
+    }
+
+    zone_mask = buf[0];
+    effect = buf[1];
+
+    if (zone_mask == 0 || zone_mask >> RAZER_ZONE_COUNT || effect >= RAZER_ZONE_EFFECT_COUNT) {
+        dev_warn(dev, "razermouse: Invalid zone mask 0x%02x or effect 0x%02x\n", zone_mask, effect);
+        return -EINVAL;
+    }
+
+    // Check every zone first so an unsupported zone doesn't leave the others changed
+    for (zone = 0; zone < RAZER_ZONE_COUNT; zone++) {
+        if (!(zone_mask & BIT(zone)))
+            continue;
+
+        zone_attr = razer_zone_effect_attrs[zone][effect];
+        if (!zone_attr || !razer_attr_exists(dev, zone_attr)) {
+            dev_warn(dev, "razermouse: Effect 0x%02x not supported for zone %u\n", effect, zone);
+            return -EINVAL;
+        }
+    }
+
+    razer_profile_lock(&device->profile, &device->lock);
+    for (zone = 0; zone < RAZER_ZONE_COUNT; zone++) {
+        if (!(zone_mask & BIT(zone)))
+            continue;
+
+        zone_attr = razer_zone_effect_attrs[zone][effect];
+        ret = zone_attr->store(dev, zone_attr, &buf[2], count - 2);
+        if (ret < 0)
+            break;
+    }
+    razer_profile_unlock(&device->profile, &device->lock);
+
+    if (ret < 0)
+        return ret;
+
+    return count;
+}
+
+static DEVICE_ATTR(zone_matrix_effect, 0220, NULL, razer_attr_write_zone_matrix_effect);
+
 #define REP4_DPI_UP  0x20
 #define REP4_DPI_DN  0x21
 #define REP4_TILT_L  0x22
@@ -6244,6 +6544,28 @@ static int razer_input_configured(struct hid_device *hdev,
     return 0;
 }
 
+/**
+ * Periodically refresh the battery state and register the power supply,
+ * stops for devices without battery
+ */
+static void razer_mouse_battery_work(struct work_struct *work)
+{
+    struct razer_mouse_device *dev = container_of(to_delayed_work(work), struct razer_mouse_device, battery.work);
+    unsigned char level, status, threshold;
+
+    if (razer_get_charge_level(dev, &level) == -EOPNOTSUPP)
+        return;
+
+    razer_get_charge_status(dev, &status);
+
+    if (dev->battery.low_threshold < 0)
+        razer_get_charge_low_threshold(dev, &threshold);
+
+    razer_battery_register(&dev->battery);
+
+    schedule_delayed_work(&dev->battery.work, msecs_to_jiffies(RAZER_BATTERY_REFRESH_MS));
+}
+
 /**
  * Mouse init function
  */
@@ -6287,6 +6609,9 @@ static void razer_mouse_init(struct razer_mouse_device *dev, struct hid_device *
     dev->tilt_hwheel = 1;
     dev->tilt_repeat_delay = 250;
     dev->tilt_repeat = 33;
+
+    razer_battery_init(&dev->battery, hdev, razer_mouse_battery_work);
+    razer_profile_init(&dev->profile);
 }
 
 /**
@@ -6326,6 +6651,8 @@ static int razer_mouse_probe(struct hid_device *hdev, const struct hid_device_id
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_type);
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_serial);
         CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_device_mode);
+        CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_apply_profile);
+        CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_zone_matrix_effect);
 
         switch(dev->usb_pid) {
         case USB_DEVICE_ID_RAZER_ABYSSUS_ELITE_DVA_EDITION:
@@ -7409,6 +7736,11 @@ static int razer_mouse_probe(struct hid_device *hdev, const struct hid_device_id
         goto exit_free;
     }
 
+    if(dev->usb_interface_protocol == USB_INTERFACE_PROTOCOL_MOUSE
+       && (expected_subclass == 0xFF || dev->usb_interface_subclass == expected_subclass)) {
+        schedule_delayed_work(&dev->battery.work, 0);
+    }
+
     //razer_reset(usb_dev);
     //razer_activate_macro_keys(usb_dev);
     //msleep(3000);
@@ -7437,6 +7769,8 @@ static void razer_mouse_disconnect(struct hid_device *hdev)
         device_remove_file(&hdev->dev, &dev_attr_device_type);
         device_remove_file(&hdev->dev, &dev_attr_device_serial);
         device_remove_file(&hdev->dev, &dev_attr_device_mode);
+        device_remove_file(&hdev->dev, &dev_attr_apply_profile);
+        device_remove_file(&hdev->dev, &dev_attr_zone_matrix_effect);
 
         switch(usb_dev->descriptor.idProduct) {
         case USB_DEVICE_ID_RAZER_ABYSSUS_ELITE_DVA_EDITION:
@@ -8506,6 +8840,7 @@ static void razer_mouse_disconnect(struct hid_device *hdev)
 
     }
 
+    razer_battery_stop(&dev->battery);
     hid_hw_stop(hdev);
     hrtimer_cancel(&dev->repeat_timer);
 
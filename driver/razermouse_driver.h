@@ -6,6 +6,8 @@
 #ifndef __HID_RAZER_MOUSE_H
 #define __HID_RAZER_MOUSE_H
 
+#include "razercommon.h"
+
 #define USB_DEVICE_ID_RAZER_OROCHI_2011 0x0013
 #define USB_DEVICE_ID_RAZER_NAGA 0x0015
 #define USB_DEVICE_ID_RAZER_DEATHADDER_3_5G 0x0016
@@ -134,6 +136,25 @@
 
 #define RAZER_MOUSE_MAX_DPI_STAGES 5
 
+// Zone bits and effects understood by "zone_matrix_effect"
+#define RAZER_ZONE_LOGO      0
+#define RAZER_ZONE_SCROLL    1
+#define RAZER_ZONE_LEFT      2
+#define RAZER_ZONE_RIGHT     3
+#define RAZER_ZONE_BACKLIGHT 4
+#define RAZER_ZONE_COUNT     5
+
+#define RAZER_ZONE_EFFECT_NONE       0x00
+#define RAZER_ZONE_EFFECT_STATIC     0x01
+#define RAZER_ZONE_EFFECT_SPECTRUM   0x02
+#define RAZER_ZONE_EFFECT_BREATH     0x03
+#define RAZER_ZONE_EFFECT_WAVE       0x04
+#define RAZER_ZONE_EFFECT_REACTIVE   0x05
+#define RAZER_ZONE_EFFECT_BLINKING   0x06
+#define RAZER_ZONE_EFFECT_ON         0x07
+#define RAZER_ZONE_EFFECT_BRIGHTNESS 0x08
+#define RAZER_ZONE_EFFECT_COUNT      0x09
+
 struct razer_mouse_device {
     struct hid_device *hdev;
     struct mutex lock;
@@ -155,6 +176,9 @@ struct razer_mouse_device {
 
     char serial[23]; // Now storing a random serial to be used with old devices that don't support it
 
+    struct razer_battery battery;
+    struct razer_profile_status profile;
+
     struct {
         unsigned char led;
         unsigned char dpi;
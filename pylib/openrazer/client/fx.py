@@ -2,6 +2,11 @@
 
 from collections.abc import Callable
 from typing import Any
+import logging as _logging
+import mmap as _mmap
+import os as _os
+import socket as _socket
+import struct as _struct
 import numpy as _np
 import numpy.typing as _npt
 import dbus as _dbus  # type: ignore
@@ -29,6 +34,70 @@ def clamp_ubyte(value: int) -> int:
     return value
 
 
+class FrameRing(object):
+    """
+    Client side of the daemon's shared memory frame ring
+
+    See openFrameRing in the daemon for the layout.
+    """
+    _header = _struct.Struct('<IIII')
+
+    def __init__(self, memfd: int, eventfd: int):
+        self._eventfd: int | None = eventfd
+        self._mmap = _mmap.mmap(memfd, _os.fstat(memfd).st_size)
+        _os.close(memfd)
+
+        self._seq, slots, frame_size, _ = self._header.unpack_from(self._mmap, 0)
+        self.slots = [memoryview(self._mmap)[self._header.size + i * frame_size:self._header.size + (i + 1) * frame_size] for i in range(slots)]
+
+    @property
+    def closed(self) -> bool:
+        return _struct.unpack_from('<I', self._mmap, 12)[0] != 0
+
+    @property
+    def next_slot(self) -> int:
+        return (self._seq + 1) % len(self.slots)
+
+    def publish(self, slot: int) -> None:
+        """
+        Make the frame in the given slot the newest one and wake up the daemon
+        """
+        self._seq = (self._seq + 1) & 0xFFFFFFFF
+        assert self._seq % len(self.slots) == slot, "Frame published out of order"
+        _struct.pack_into('<I', self._mmap, 0, self._seq)
+        assert self._eventfd is not None, "Frame ring is closed"
+        _os.eventfd_write(self._eventfd, 1)
+
+    # Rings whose mapping couldn't be closed yet, retried on every close
+    _unclosed: list['FrameRing'] = []
+
+    def _unmap(self) -> bool:
+        """
+        Release the slot views and unmap the ring
+
+        :return: False if something outside still holds a view of a slot
+        :rtype: bool
+        """
+        try:
+            for slot in self.slots:
+                slot.release()
+            self._mmap.close()
+        except BufferError:
+            return False
+        return True
+
+    def close(self) -> None:
+        if self._eventfd is not None:
+            _os.close(self._eventfd)
+            self._eventfd = None
+
+        FrameRing._unclosed = [ring for ring in FrameRing._unclosed if ring is not self and not ring._unmap()]
+
+        if not self._unmap():
+            _logging.getLogger('razer.client').warning("Frame ring slot still in use, keeping the ring mapped until it's released")
+            FrameRing._unclosed.append(self)
+
+
 # Default Chroma lighting
 class BaseRazerFX(object):
     def __init__(self, serial: str, capabilities: dict[str, bool], daemon_dbus: _dbus.proxies.ProxyObject):
@@ -67,6 +136,11 @@ class RazerAdvancedFX(BaseRazerFX):
         self._matrix_dims = matrix_dims
         self._lighting_dbus = _dbus.Interface(daemon_dbus, "razer.device.lighting.chroma")
 
+        self._frame_stream: _socket.socket | None = None
+        self._frame_stream_supported = True
+        self._frame_ring: FrameRing | None = None
+        self._frame_ring_supported = True
+
         self.matrix = Frame(matrix_dims)
 
     @property
@@ -89,8 +163,74 @@ class RazerAdvancedFX(BaseRazerFX):
         """
         return self._matrix_dims[0]
 
-    def _draw(self, ba: bytes) -> None:
-        self._lighting_dbus.setKeyRow(ba)
+    def _open_frame_stream(self) -> _socket.socket | None:
+        try:
+            fd = self._lighting_dbus.openFrameStream()
+        except _dbus.exceptions.DBusException:
+            # Older daemon, keep using setKeyRow
+            self._frame_stream_supported = False
+            return None
+
+        return _socket.socket(fileno=fd.take())
+
+    def _close_frame_stream(self) -> None:
+        if self._frame_stream is not None:
+            self._frame_stream.close()
+            self._frame_stream = None
+
+    def _open_frame_ring(self) -> FrameRing | None:
+        try:
+            memfd, eventfd = self._lighting_dbus.openFrameRing()
+        except _dbus.exceptions.DBusException:
+            # Older daemon or a device without matrix dimensions
+            self._frame_ring_supported = False
+            return None
+
+        return FrameRing(memfd.take(), eventfd.take())
+
+    def _close_frame_ring(self) -> None:
+        if self._frame_ring is not None:
+            self.matrix.unbind()
+            self._frame_ring.close()
+            self._frame_ring = None
+
+    def _draw_ring(self) -> bool:
+        """
+        Publish the current frame through the shared memory ring
+
+        :return: False if the ring isn't available
+        :rtype: bool
+        """
+        if not self._frame_ring_supported:
+            return False
+
+        if self._frame_ring is not None and self._frame_ring.closed:
+            # The daemon dropped the ring, get a new one
+            self._close_frame_ring()
+
+        if self._frame_ring is None:
+            self._frame_ring = self._open_frame_ring()
+            if self._frame_ring is None:
+                return False
+            self.matrix.bind(self._frame_ring.slots, self._frame_ring.next_slot)
+
+        self._frame_ring.publish(self.matrix.advance())
+        return True
+
+    def _draw(self, ba: bytes | memoryview) -> None:
+        if self._frame_stream_supported:
+            if self._frame_stream is None:
+                self._frame_stream = self._open_frame_stream()
+
+            if self._frame_stream is not None:
+                try:
+                    self._frame_stream.send(ba)
+                    return
+                except OSError:
+                    # The daemon restarted or dropped the stream, reopen it on the next frame
+                    self._close_frame_stream()
+
+        self._lighting_dbus.setKeyRow(bytes(ba))
 
         self._lighting_dbus.setCustom()
 
@@ -98,10 +238,12 @@ class RazerAdvancedFX(BaseRazerFX):
         """
         Draw what's in the current frame buffer
         """
-        self._draw(bytes(self.matrix))
+        if not self._draw_ring():
+            self._draw(self.matrix.payload)
 
     def draw_fb_or(self) -> None:
-        self._draw(bytes(self.matrix.draw_with_fb_or()))
+        self.matrix.draw_with_fb_or()
+        self.draw()
 
     def set_key(self, column_id: int, rgb: bytes, row_id: int = 0) -> None:  # Not needed on mice
         if self.has('led_single'):
@@ -119,6 +261,8 @@ class RazerAdvancedFX(BaseRazerFX):
         """
         Restore the device to the last effect
         """
+        self._close_frame_stream()
+        self._close_frame_ring()
         self._lighting_dbus.restoreLastEffect()
 
 
@@ -1046,12 +1190,18 @@ class Frame(object):
     """
     Class to represent the RGB matrix of the keyboard. So to animate you'd use multiple frames
     """
+    _payload: _npt.NDArray[_np.uint8]
     _matrix: _npt.NDArray[_np.uint8]
     _fb1: _npt.NDArray[_np.uint8]
+    _private: tuple[_npt.NDArray[_np.uint8], _npt.NDArray[_np.uint8]]
+    _slots: list[tuple[_npt.NDArray[_np.uint8], _npt.NDArray[_np.uint8]]] | None
 
     def __init__(self, dimensions: tuple[int, int]):
         self._rows, self._cols = dimensions
         self._components = 3
+        self._row_size = 3 + self._cols * self._components
+        self._slots = None
+        self._slot = 0
 
         self._init()
 
@@ -1101,11 +1251,44 @@ class Frame(object):
         :return: Driver binary payload
         :rtype: bytes
         """
-        return b''.join([self.row_binary(row_id) for row_id in range(0, self._rows)])
+        return self._payload.tobytes()
+
+    @property
+    def payload(self) -> memoryview:
+        """
+        Driver payload of the whole frame without copying it
+
+        Only valid until the frame is changed.
+
+        :return: Driver binary payload
+        :rtype: memoryview
+        """
+        return self._payload.data.cast('B')
+
+    def _wire_format(self, buffer: Any) -> tuple[_npt.NDArray[_np.uint8], _npt.NDArray[_np.uint8]]:
+        """
+        Lay out a buffer as driver payload, one row after the other
+
+        Each row is ROW_ID START_COL STOP_COL followed by RGB for every column.
+        The headers are filled in here and never change.
+
+        :param buffer: Buffer of rows * (3 + cols * 3) bytes
+        :type buffer: buffer
+
+        :return: Payload array and a (components, rows, cols) view of its RGB data
+        :rtype: tuple
+        """
+        payload = _np.frombuffer(buffer, dtype=_np.uint8).reshape(self._rows, self._row_size)
+        payload[:, 0] = _np.arange(self._rows)
+        payload[:, 1] = 0
+        payload[:, 2] = self._cols - 1
+
+        return payload, payload[:, 3:].reshape(self._rows, self._cols, self._components).transpose(2, 0, 1)
 
     def _init(self) -> None:
-        self._matrix = _np.zeros((self._components, self._rows, self._cols), 'uint8')
-        self._fb1 = _np.copy(self._matrix)
+        self._private = self._wire_format(bytearray(self._rows * self._row_size))
+        self._payload, self._matrix = self._private
+        self._fb1 = _np.zeros((self._components, self._rows, self._cols), 'uint8')
 
     def reset(self) -> None:
         """
@@ -1162,10 +1345,7 @@ class Frame(object):
         """
         assert 0 <= row_id < self._rows, "Row out of bounds"
 
-        start = 0
-        end = self._cols - 1
-
-        return row_id.to_bytes(1, byteorder='big') + start.to_bytes(1, byteorder='big') + end.to_bytes(1, byteorder='big') + self._matrix[:, row_id].tobytes(order='F')
+        return self._payload[row_id].tobytes()
 
     def to_binary(self) -> bytes:
         """
@@ -1178,11 +1358,60 @@ class Frame(object):
 
     # Simple FB
     def to_framebuffer(self) -> None:
-        self._fb1 = _np.copy(self._matrix)
+        _np.copyto(self._fb1, self._matrix)
 
     def to_framebuffer_or(self) -> None:
-        self._fb1 = _np.bitwise_or(self._fb1, self._matrix)  # pylint: disable=no-member
+        _np.bitwise_or(self._fb1, self._matrix, out=self._fb1)  # pylint: disable=no-member
 
-    def draw_with_fb_or(self) -> bytes:
-        self._matrix = _np.bitwise_or(self._fb1, self._matrix)  # pylint: disable=no-member
-        return bytes(self)
+    def draw_with_fb_or(self) -> memoryview:
+        """
+        OR the framebuffer into the frame
+
+        :return: Driver payload of the frame, only valid until the frame is changed
+        :rtype: memoryview
+        """
+        _np.bitwise_or(self._fb1, self._matrix, out=self._matrix)  # pylint: disable=no-member
+        return self.payload
+
+    def bind(self, buffers: list[memoryview], slot: int) -> None:
+        """
+        Paint straight into driver payloads kept in the given buffers
+
+        Every buffer holds a full frame in the driver format, so publishing a
+        frame doesn't need any conversion.
+
+        :param buffers: Frame ring slots
+        :type buffers: list
+
+        :param slot: Slot of the next frame
+        :type slot: int
+        """
+        self._slots = [self._wire_format(buffer) for buffer in buffers]
+        self._slot = slot
+        self._slots[self._slot][1][...] = self._matrix
+        self._payload, self._matrix = self._slots[self._slot]
+
+    def unbind(self) -> None:
+        """
+        Go back to the private payload buffer
+        """
+        if self._slots is not None:
+            self._private[1][...] = self._matrix
+            self._payload, self._matrix = self._private
+            self._slots = None
+
+    def advance(self) -> int:
+        """
+        Finish the frame in the current slot and carry it over to the next one
+
+        :return: Slot holding the finished frame
+        :rtype: int
+        """
+        assert self._slots is not None, "Frame isn't bound to a ring"
+
+        done = self._slot
+        self._slot = (self._slot + 1) % len(self._slots)
+        self._slots[self._slot][1][...] = self._matrix
+        self._payload, self._matrix = self._slots[self._slot]
+
+        return done